@@ -0,0 +1,151 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    //A monotonic memory resource for closures built and torn down together:
+    //reset() releases all of its memory at once, so the closures allocated from it
+    //must be destroyed before that.
+    class Arena : public std::pmr::monotonic_buffer_resource
+    {
+    public:
+        using monotonic_buffer_resource::monotonic_buffer_resource;
+
+        void reset() noexcept { release(); }
+    };
+
+    namespace Detail
+    {
+        //The bound arguments are constructed with the allocator when they are allocator-aware,
+        //so the state of a closure binding a std::pmr::vector lives entirely in the resource.
+        template <typename F, typename... Bound>
+        struct AllocatedState
+        {
+            using Allocator = std::pmr::polymorphic_allocator<>;
+
+            template <typename G, typename... Args>
+            AllocatedState(const Allocator& alloc, G&& f, Args&&... args)
+                : f(std::forward<G>(f)),
+                  bound(std::make_obj_using_allocator<std::tuple<Bound...>>(alloc, std::forward<Args>(args)...))
+            {
+            }
+
+            [[no_unique_address]] F f;
+            std::tuple<Bound...> bound;
+        };
+
+        //A handle, two pointers in size, owning state allocated from a memory resource.
+        //A curried closure returns a new one when called with too few arguments.
+        template <bool isCurried, typename F, typename... Bound>
+        class AllocatedClosure
+        {
+        private:
+            using State = AllocatedState<F, Bound...>;
+            using Allocator = std::pmr::polymorphic_allocator<>;
+
+            template <bool, typename, typename...>
+            friend class AllocatedClosure;
+
+        public:
+            template <typename G, typename... Args>
+            AllocatedClosure(const Allocator& alloc, G&& f, Args&&... args)
+                : resource(alloc.resource()),
+                  state(allocator().template new_object<State>(alloc, std::forward<G>(f), std::forward<Args>(args)...))
+            {
+            }
+
+            //the copy is allocated from the same resource
+            AllocatedClosure(const AllocatedClosure& source)
+                : resource(source.resource),
+                  state(std::apply([&source, this](const auto&... args)
+                  {
+                      return allocator().template new_object<State>(allocator(), source.state->f, args...);
+                  }, source.state->bound))
+            {
+            }
+
+            AllocatedClosure(AllocatedClosure&& source) noexcept
+                : resource(source.resource),
+                  state(std::exchange(source.state, nullptr))
+            {
+            }
+
+            AllocatedClosure& operator=(AllocatedClosure rhs) noexcept
+            {
+                std::swap(resource, rhs.resource);
+                std::swap(state, rhs.state);
+                return *this;
+            }
+
+            ~AllocatedClosure()
+            {
+                if (state) {
+                    allocator().delete_object(state);
+                }
+            }
+
+            template <typename... Rest>
+            decltype(auto) operator()(Rest&&... rest) const &
+            {
+                if constexpr (std::is_invocable_v<const F&, const Bound&..., Rest...>) {
+                    return std::apply([this, &rest...](const auto&... args) -> decltype(auto)
+                    {
+                        return (invoke)(state->f, args..., std::forward<Rest>(rest)...);
+                    }, state->bound);
+                }
+                else {
+                    static_assert(isCurried, "Incompatible arguments supplied");
+                    return std::apply([this, &rest...](const auto&... args)
+                    {
+                        using Next = AllocatedClosure<true, F, Bound..., std::decay_t<Rest>...>;
+                        return Next{ allocator(), state->f, args..., std::forward<Rest>(rest)... };
+                    }, state->bound);
+                }
+            }
+
+            //a temporary curried closure hands its bound arguments over to the next one
+            template <typename... Rest>
+            decltype(auto) operator()(Rest&&... rest) &&
+            {
+                if constexpr (std::is_invocable_v<const F&, const Bound&..., Rest...>) {
+                    return std::as_const(*this)(std::forward<Rest>(rest)...);
+                }
+                else {
+                    static_assert(isCurried, "Incompatible arguments supplied");
+                    return std::apply([this, &rest...](auto&... args)
+                    {
+                        using Next = AllocatedClosure<true, F, Bound..., std::decay_t<Rest>...>;
+                        return Next{ allocator(), std::move(state->f), std::move(args)..., std::forward<Rest>(rest)... };
+                    }, state->bound);
+                }
+            }
+
+        private:
+            Allocator allocator() const noexcept { return resource; }
+
+            std::pmr::memory_resource* resource;
+            State* state;
+        };
+    } //namespace Detail
+
+    //curry(f) with the function and the accumulated arguments allocated from alloc
+    template <typename F>
+    auto allocateCurry(std::pmr::polymorphic_allocator<> alloc, F f)
+    {
+        return Detail::AllocatedClosure<true, F>{ alloc, std::move(f) };
+    }
+
+    //bindFront(f, args...) with the function and the bound arguments allocated from alloc
+    template <typename F, typename... Args>
+    auto allocateBind(std::pmr::polymorphic_allocator<> alloc, F f, Args&&... args)
+    {
+        return Detail::AllocatedClosure<false, F, std::decay_t<Args>...>{ alloc, std::move(f), std::forward<Args>(args)... };
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
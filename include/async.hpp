@@ -0,0 +1,155 @@
+#pragma once
+
+#include "functional.hpp"
+#include "threadPool.hpp"
+#include <exception>
+#include <future>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename Executor, typename... Futures>
+        void waitAll(Executor& executor, const std::tuple<Futures...>& futures)
+        {
+            std::apply([&executor](const auto&... fs) { (executor.wait(fs), ...); }, futures);
+        }
+
+        template <typename Executor, typename F, typename G, typename... Gs>
+        class SuperposedAsync
+        {
+        public:
+            SuperposedAsync(Executor& executor, F f, G g, Gs... funs)
+                : executor(&executor),
+                  f(std::move(f)),
+                  g(std::move(g)),
+                  funs(std::move(funs)...)
+            {
+            }
+
+            //the first branch runs on the calling thread while the others are posted to the executor,
+            //which the calling thread helps until all of them are done
+            template <typename... Args>
+            decltype(auto) operator()(const Args&... args) const
+            {
+                static_assert(andAll(std::is_invocable_v<const G&, const Args&...>,
+                                     std::is_invocable_v<const Gs&, const Args&...>...),
+                              "Incompatible arguments given to Gs or their signatures are incompatible");
+
+                auto futures = std::apply([this, &args...](const auto&... gs)
+                {
+                    return std::tuple{ executor->submit([&gs, &args...] { return (invoke)(gs, args...); })... };
+                }, funs);
+
+                //the posted branches refer to the arguments, so they must finish before an exception leaves
+                auto first = [&]
+                {
+                    try {
+                        return (invoke)(g, args...);
+                    }
+                    catch (...) {
+                        waitAll(*executor, futures);
+                        throw;
+                    }
+                }();
+                waitAll(*executor, futures);
+
+                return std::apply([this, &first](auto&... fs) -> decltype(auto)
+                {
+                    return (invoke)(f, std::move(first), fs.get()...);
+                }, futures);
+            }
+
+        private:
+            Executor* executor;
+            [[no_unique_address]] F f;
+            [[no_unique_address]] G g;
+            [[no_unique_address]] std::tuple<Gs...> funs;
+        };
+
+        template <typename Executor, typename... Fs>
+        class ComposedAsync
+        {
+        private:
+            using Funs = std::tuple<Fs...>;
+            static constexpr auto last = sizeof...(Fs) - 1;
+
+        public:
+            ComposedAsync(Executor& executor, Fs... funs)
+                : executor(&executor),
+                  funs(std::make_shared<const Funs>(std::move(funs)...))
+            {
+            }
+
+            //the arguments are copied, as the functions run after the call returns;
+            //each function runs as a separate task posted when the previous one is done
+            template <typename... Args>
+            auto operator()(Args&&... args) const
+            {
+                static_assert(std::is_invocable_v<const Composed<Fs...>&, std::decay_t<Args>...>,
+                              "Incompatible arguments given to the composed functions");
+                using R = std::decay_t<std::invoke_result_t<const Composed<Fs...>&, std::decay_t<Args>...>>;
+
+                auto promise = std::promise<R>{};
+                auto result = promise.get_future();
+                executor->post([executor = executor, funs = funs, promise = std::move(promise),
+                                args = std::tuple<std::decay_t<Args>...>{ std::forward<Args>(args)... }]() mutable
+                {
+                    std::apply([&](auto&... xs)
+                    {
+                        stage<last>(*executor, std::move(funs), std::move(promise), std::move(xs)...);
+                    }, args);
+                });
+                return result;
+            }
+
+        private:
+            template <std::size_t I, typename R, typename... Values>
+            static void stage(Executor& executor, std::shared_ptr<const Funs> funs, std::promise<R> promise, Values... values)
+            {
+                try {
+                    if constexpr (I == 0 && std::is_void_v<R>) {
+                        (invoke)(std::get<I>(*funs), std::move(values)...);
+                        promise.set_value();
+                    }
+                    else if constexpr (I == 0) {
+                        promise.set_value((invoke)(std::get<I>(*funs), std::move(values)...));
+                    }
+                    else {
+                        auto result = (invoke)(std::get<I>(*funs), std::move(values)...);
+                        executor.post([&executor, funs, promise = std::move(promise), result = std::move(result)]() mutable
+                        {
+                            stage<I - 1>(executor, std::move(funs), std::move(promise), std::move(result));
+                        });
+                    }
+                }
+                catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+            }
+
+            Executor* executor;
+            std::shared_ptr<const Funs> funs;
+        };
+    } //namespace Detail
+
+    //as superpose, but the Gs run as separate tasks of executor and F is called once all of them are done;
+    //the executor must outlive the result
+    template <typename Executor, typename F, typename G, typename... Gs>
+    auto superposeAsync(Executor& executor, F f, G g, Gs... funs)
+    {
+        return Detail::SuperposedAsync<Executor, F, G, Gs...>{ executor, std::move(f), std::move(g), std::move(funs)... };
+    }
+
+    //as compose, but the call returns a std::future and the functions run as a chain of tasks of executor;
+    //the executor must outlive the result
+    template <typename Executor, typename F, typename G, typename... Gs>
+    auto composeAsync(Executor& executor, F f, G g, Gs... funs)
+    {
+        return Detail::ComposedAsync<Executor, F, G, Gs...>{ executor, std::move(f), std::move(g), std::move(funs)... };
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
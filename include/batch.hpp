@@ -0,0 +1,411 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if !defined(IDRAGNEV_FUNCTIONAL_NO_SIMD) && __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define IDRAGNEV_FUNCTIONAL_SIMD 1
+#endif
+
+namespace IDragnev::Functional
+{
+    class Bitmask
+    {
+    public:
+        using Word = std::uint64_t;
+        static constexpr std::size_t wordBits = 64;
+
+        Bitmask() = default;
+
+        explicit Bitmask(std::size_t size, bool value = false)
+            : bits(wordsFor(size), value ? ~Word{ 0 } : Word{ 0 }),
+              bitCount(size)
+        {
+            clearPadding();
+        }
+
+        std::size_t size() const noexcept { return bitCount; }
+        bool empty() const noexcept { return bitCount == 0; }
+
+        bool operator[](std::size_t i) const noexcept
+        {
+            assert(i < bitCount);
+            return (bits[i / wordBits] >> (i % wordBits)) & 1;
+        }
+
+        void set(std::size_t i, bool value = true) noexcept
+        {
+            assert(i < bitCount);
+            const auto bit = Word{ 1 } << (i % wordBits);
+            auto& word = bits[i / wordBits];
+            word = value ? (word | bit) : (word & ~bit);
+        }
+
+        std::size_t count() const noexcept
+        {
+            auto result = std::size_t{ 0 };
+            for (auto word : bits) {
+                result += std::popcount(word);
+            }
+            return result;
+        }
+
+        //the positions of the set bits in increasing order
+        std::vector<std::size_t> selection() const
+        {
+            auto result = std::vector<std::size_t>{};
+            result.reserve(count());
+            for (auto i = std::size_t{ 0 }; i < bits.size(); ++i) {
+                for (auto word = bits[i]; word != 0; word &= word - 1) {
+                    result.push_back(i * wordBits + std::countr_zero(word));
+                }
+            }
+            return result;
+        }
+
+        std::span<Word> words() noexcept { return bits; }
+        std::span<const Word> words() const noexcept { return bits; }
+
+        Bitmask& operator&=(const Bitmask& other) noexcept
+        {
+            assert(bitCount == other.bitCount);
+            for (auto i = std::size_t{ 0 }; i < bits.size(); ++i) {
+                bits[i] &= other.bits[i];
+            }
+            return *this;
+        }
+
+        Bitmask& operator|=(const Bitmask& other) noexcept
+        {
+            assert(bitCount == other.bitCount);
+            for (auto i = std::size_t{ 0 }; i < bits.size(); ++i) {
+                bits[i] |= other.bits[i];
+            }
+            return *this;
+        }
+
+        Bitmask& flip() noexcept
+        {
+            for (auto& word : bits) {
+                word = ~word;
+            }
+            clearPadding();
+            return *this;
+        }
+
+        friend Bitmask operator&(Bitmask lhs, const Bitmask& rhs) noexcept { return lhs &= rhs; }
+        friend Bitmask operator|(Bitmask lhs, const Bitmask& rhs) noexcept { return lhs |= rhs; }
+        friend Bitmask operator~(Bitmask mask) noexcept { return mask.flip(); }
+        friend bool operator==(const Bitmask&, const Bitmask&) = default;
+
+    private:
+        static constexpr std::size_t wordsFor(std::size_t size) noexcept
+        {
+            return (size + wordBits - 1) / wordBits;
+        }
+
+        void clearPadding() noexcept
+        {
+            if (const auto tail = bitCount % wordBits; tail != 0) {
+                bits.back() &= (Word{ 1 } << tail) - 1;
+            }
+        }
+
+        std::vector<Word> bits;
+        std::size_t bitCount = 0;
+    };
+
+    namespace Detail
+    {
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+        namespace stdx = std::experimental;
+
+        template <typename T>
+        using Vector = stdx::native_simd<T>;
+
+        template <typename T>
+        inline constexpr bool isVectorizable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+        //Op can be applied lane-wise with the same results as the scalar call
+        template <typename Op, typename T, typename Rhs, typename Result>
+        constexpr bool hasVectorKernel() noexcept
+        {
+            if constexpr (!isVectorizable<T> || !std::is_arithmetic_v<Rhs>) {
+                return false;
+            }
+            else if constexpr (!std::is_same_v<std::common_type_t<T, Rhs>, T> ||
+                               !std::is_same_v<std::invoke_result_t<const Op&, const T&, const Rhs&>, Result> ||
+                               !std::is_invocable_v<const Op&, Vector<T>, Vector<T>>) {
+                return false;
+            }
+            else {
+                using VectorResult = std::invoke_result_t<const Op&, Vector<T>, Vector<T>>;
+                if constexpr (std::is_same_v<Result, bool>) {
+                    return stdx::is_simd_mask_v<VectorResult>;
+                }
+                else {
+                    return std::is_same_v<VectorResult, Vector<T>>;
+                }
+            }
+        }
+#endif
+
+        //out[i] = f(in[i]) where vectorF is the same as f but on a whole vector of lanes,
+        //nullptr stands for no vectorF and out must be at least as long as in
+        template <typename T, typename U, typename VectorF, typename F>
+        void transformBatch(std::span<const T> in, std::span<U> out, [[maybe_unused]] const VectorF& vectorF, const F& f)
+        {
+            if (out.size() < in.size()) {
+                throw std::invalid_argument{ "The output range must be at least as long as the input range" };
+            }
+            auto i = std::size_t{ 0 };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (!std::is_null_pointer_v<VectorF>) {
+                static_assert(std::is_same_v<T, U>);
+                using V = Vector<T>;
+                for (; i + V::size() <= in.size(); i += V::size()) {
+                    const auto x = V(in.data() + i, stdx::element_aligned);
+                    V(vectorF(x)).copy_to(out.data() + i, stdx::element_aligned);
+                }
+            }
+#endif
+            for (; i < in.size(); ++i) {
+                out[i] = f(in[i]);
+            }
+        }
+
+        //bit i of the result is set when p(in[i]) holds, vectorP is p on a whole vector of lanes
+        //and nullptr stands for no vectorP
+        template <typename T, typename VectorP, typename P>
+        Bitmask maskBatch(std::span<const T> in, [[maybe_unused]] const VectorP& vectorP, const P& p)
+        {
+            using Word = Bitmask::Word;
+            constexpr auto wordBits = Bitmask::wordBits;
+
+            auto result = Bitmask(in.size());
+            auto words = result.words();
+            auto i = std::size_t{ 0 };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (!std::is_null_pointer_v<VectorP>) {
+                using V = Vector<T>;
+                static_assert(wordBits % V::size() == 0);
+                bool flags[wordBits];
+                for (; i + wordBits <= in.size(); i += wordBits) {
+                    for (auto lane = std::size_t{ 0 }; lane < wordBits; lane += V::size()) {
+                        const auto x = V(in.data() + i + lane, stdx::element_aligned);
+                        vectorP(x).copy_to(flags + lane, stdx::element_aligned);
+                    }
+                    auto word = Word{ 0 };
+                    for (auto bit = std::size_t{ 0 }; bit < wordBits; ++bit) {
+                        word |= Word{ flags[bit] } << bit;
+                    }
+                    words[i / wordBits] = word;
+                }
+            }
+#endif
+            for (; i < in.size(); ++i) {
+                words[i / wordBits] |= Word{ static_cast<bool>(p(in[i])) } << (i % wordBits);
+            }
+            return result;
+        }
+
+        template <typename Op, typename T, typename Rhs, typename U>
+        void applyRightSection(const Op& op, const Rhs& rhs, std::span<const T> in, std::span<U> out)
+        {
+            const auto scalar = [&op, &rhs](const T& x) { return (invoke)(op, x, rhs); };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (std::is_same_v<T, U> && hasVectorKernel<Op, T, Rhs, T>()) {
+                const auto r = Vector<T>(static_cast<T>(rhs));
+                const auto vector = [&op, &r](const Vector<T>& x) { return op(x, r); };
+                transformBatch(in, out, vector, scalar);
+                return;
+            }
+#endif
+            transformBatch(in, out, nullptr, scalar);
+        }
+
+        template <typename Op, typename T, typename Rhs>
+        Bitmask maskRightSection(const Op& op, const Rhs& rhs, std::span<const T> in)
+        {
+            const auto scalar = [&op, &rhs](const T& x) { return (invoke)(op, x, rhs); };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (hasVectorKernel<Op, T, Rhs, bool>()) {
+                const auto r = Vector<T>(static_cast<T>(rhs));
+                const auto vector = [&op, &r](const Vector<T>& x) { return op(x, r); };
+                return maskBatch(in, vector, scalar);
+            }
+#endif
+            return maskBatch(in, nullptr, scalar);
+        }
+
+        //the elements of a contiguous range as read by the kernels, const even for mutable ranges
+        template <typename Range>
+        auto asSpan(const Range& range) noexcept
+        {
+            return std::span<const std::ranges::range_value_t<Range>>{ std::ranges::data(range), std::ranges::size(range) };
+        }
+
+        //the elements of a contiguous range as written by the kernels
+        template <typename Range>
+        auto asOutputSpan(Range&& range) noexcept
+        {
+            return std::span{ std::ranges::data(range), std::ranges::size(range) };
+        }
+
+        inline constexpr std::size_t blockRows = 4096;
+
+        template <typename P, typename In, typename = void>
+        struct HasMask : std::false_type { };
+
+        template <typename P, typename In>
+        struct HasMask<P, In, std::void_t<decltype(std::declval<const P&>().mask(std::declval<const In&>()))>> : std::true_type { };
+
+        //the mask of p over a contiguous range, through p.mask when p has one
+        template <typename P, typename T>
+        Bitmask maskOf(const P& p, std::span<const T> in)
+        {
+            if constexpr (HasMask<P, std::span<const T>>::value) {
+                return p.mask(in);
+            }
+            else {
+                return maskBatch(in, nullptr, [&p](const T& x) { return (invoke)(p, x); });
+            }
+        }
+
+        //The masks of the predicates are computed and combined one block of rows at a time,
+        //so that each block is still in the cache when the next predicate reads it.
+        //Without predicates every bit is identityBit, the identity of combine.
+        template <typename Combine, typename... Ps, typename T>
+        Bitmask combineMasks(const std::tuple<Ps...>& predicates, std::span<const T> in, Combine combine, bool identityBit)
+        {
+            static_assert(blockRows % Bitmask::wordBits == 0);
+
+            if constexpr (sizeof...(Ps) == 0) {
+                return Bitmask(in.size(), identityBit);
+            }
+            else {
+                auto result = Bitmask(in.size());
+                auto words = result.words();
+                for (auto first = std::size_t{ 0 }; first < in.size(); first += blockRows) {
+                    const auto block = in.subspan(first, std::min(blockRows, in.size() - first));
+                    const auto mask = std::apply([block, &combine](const auto& p, const auto&... ps)
+                    {
+                        auto result = maskOf(p, block);
+                        (combine(result, maskOf(ps, block)), ...);
+                        return result;
+                    }, predicates);
+                    std::copy(std::begin(mask.words()), std::end(mask.words()), std::begin(words) + first / Bitmask::wordBits);
+                }
+                return result;
+            }
+        }
+
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+        template <typename E, typename T, typename Result>
+        constexpr bool isLaneWise() noexcept
+        {
+            if constexpr (!isVectorizable<T> || !std::is_invocable_v<const E&, const Vector<T>&>) {
+                return false;
+            }
+            else if constexpr (!std::is_same_v<std::invoke_result_t<const E&, const T&>, Result>) {
+                return false;
+            }
+            else {
+                using VectorResult = std::invoke_result_t<const E&, const Vector<T>&>;
+                if constexpr (std::is_same_v<Result, bool>) {
+                    return stdx::is_simd_mask_v<VectorResult>;
+                }
+                else {
+                    return std::is_same_v<VectorResult, Vector<T>>;
+                }
+            }
+        }
+#endif
+
+        template <typename E, typename T, typename U>
+        void applyExpression(const E& e, std::span<const T> in, std::span<U> out)
+        {
+            const auto scalar = [&e](const T& x) { return e(x); };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (std::is_same_v<T, U> && isLaneWise<E, T, T>()) {
+                const auto vector = [&e](const Vector<T>& x) { return e(x); };
+                transformBatch(in, out, vector, scalar);
+                return;
+            }
+#endif
+            transformBatch(in, out, nullptr, scalar);
+        }
+
+        template <typename E, typename T>
+        Bitmask maskExpression(const E& e, std::span<const T> in)
+        {
+            const auto scalar = [&e](const T& x) { return e(x); };
+#ifdef IDRAGNEV_FUNCTIONAL_SIMD
+            if constexpr (isLaneWise<E, T, bool>()) {
+                const auto vector = [&e](const Vector<T>& x) { return e(x); };
+                return maskBatch(in, vector, scalar);
+            }
+#endif
+            return maskBatch(in, nullptr, scalar);
+        }
+
+        template <typename In>
+        struct BatchKernels
+        {
+            template <typename Op, typename Rhs, typename Out>
+            static void applySection(const Op& op, const Rhs& rhs, const In& in, Out&& out)
+            {
+                applyRightSection(op, rhs, asSpan(in), asOutputSpan(out));
+            }
+
+            template <typename Op, typename Rhs>
+            static Bitmask maskSection(const Op& op, const Rhs& rhs, const In& in)
+            {
+                return maskRightSection(op, rhs, asSpan(in));
+            }
+
+            template <typename E, typename Out>
+            static void applyExpression(const E& e, const In& in, Out&& out)
+            {
+                Detail::applyExpression(e, asSpan(in), asOutputSpan(out));
+            }
+
+            template <typename E>
+            static Bitmask maskExpression(const E& e, const In& in)
+            {
+                return Detail::maskExpression(e, asSpan(in));
+            }
+
+            template <typename P>
+            static Bitmask maskInverse(const P& p, const In& in)
+            {
+                return ~maskOf(p, asSpan(in));
+            }
+
+            template <typename... Ps>
+            static Bitmask maskAll(const std::tuple<Ps...>& predicates, const In& in)
+            {
+                return combineMasks(predicates, asSpan(in), [](Bitmask& lhs, const Bitmask& rhs) { lhs &= rhs; }, true);
+            }
+
+            template <typename... Ps>
+            static Bitmask maskAny(const std::tuple<Ps...>& predicates, const In& in)
+            {
+                return combineMasks(predicates, asSpan(in), [](Bitmask& lhs, const Bitmask& rhs) { lhs |= rhs; }, false);
+            }
+        };
+    } //namespace Detail
+} //namespace IDragnev::Functional
+
+#include "instantiations.hpp"
\ No newline at end of file
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "callableTraits.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename Arg, typename F>
+        using BatchResult = typename std::invoke_result_t<F&, std::span<const Arg>>::value_type;
+
+        //The arguments of the calls wait in a batch which is passed to f as a whole
+        //when it reaches maxBatch arguments, by the call completing it,
+        //or maxDelay after its first argument, by a thread of the batcher.
+        //So f can be called by several threads at once.
+        template <typename Arg, typename F>
+        class Batcher
+        {
+        private:
+            using Result = BatchResult<Arg, F>;
+            using Clock = std::chrono::steady_clock;
+
+            struct Batch
+            {
+                std::vector<Arg> args;
+                std::vector<std::promise<Result>> promises;
+            };
+
+        public:
+            Batcher(F f, std::size_t maxBatch, std::chrono::nanoseconds maxDelay)
+                : f(std::move(f)),
+                  maxBatch(std::max<std::size_t>(1, maxBatch)),
+                  maxDelay(maxDelay),
+                  flusher([this] { flushOnDeadlines(); })
+            {
+            }
+
+            Batcher(const Batcher&) = delete;
+            Batcher& operator=(const Batcher&) = delete;
+
+            //the pending batch is passed to f before the flusher is joined
+            ~Batcher()
+            {
+                {
+                    auto lock = std::lock_guard{ guard };
+                    stopping = true;
+                }
+                wakeUp.notify_one();
+                flusher.join();
+            }
+
+            template <typename A>
+            std::future<Result> submit(A&& arg)
+            {
+                auto lock = std::unique_lock{ guard };
+                if (pending.args.empty()) {
+                    deadline = Clock::now() + maxDelay;
+                    wakeUp.notify_one();
+                }
+                pending.args.emplace_back(std::forward<A>(arg));
+                auto result = pending.promises.emplace_back().get_future();
+                if (pending.args.size() >= maxBatch) {
+                    auto full = std::exchange(pending, Batch{});
+                    lock.unlock();
+                    run(full);
+                }
+                return result;
+            }
+
+        private:
+            void flushOnDeadlines()
+            {
+                auto lock = std::unique_lock{ guard };
+                while (!stopping) {
+                    if (pending.args.empty()) {
+                        wakeUp.wait(lock, [this] { return stopping || !pending.args.empty(); });
+                    }
+                    else if (!wakeUp.wait_until(lock, deadline, [this] { return stopping || pending.args.empty(); })) {
+                        auto due = std::exchange(pending, Batch{});
+                        lock.unlock();
+                        run(due);
+                        lock.lock();
+                    }
+                }
+                auto rest = std::exchange(pending, Batch{});
+                lock.unlock();
+                run(rest);
+            }
+
+            void run(Batch& batch) noexcept
+            {
+                if (batch.args.empty()) {
+                    return;
+                }
+                //the promises before it have values, so a failure only reaches the rest of them
+                auto fulfilled = std::size_t{ 0 };
+                try {
+                    auto results = (invoke)(f, std::span<const Arg>{ batch.args });
+                    if (results.size() != batch.args.size()) {
+                        throw std::length_error{ "A batched function must return a result per argument" };
+                    }
+                    for (; fulfilled < results.size(); ++fulfilled) {
+                        batch.promises[fulfilled].set_value(std::move(results[fulfilled]));
+                    }
+                }
+                catch (...) {
+                    for (auto i = fulfilled; i < batch.promises.size(); ++i) {
+                        batch.promises[i].set_exception(std::current_exception());
+                    }
+                }
+            }
+
+            [[no_unique_address]] F f;
+            const std::size_t maxBatch;
+            const std::chrono::nanoseconds maxDelay;
+            std::mutex guard;
+            std::condition_variable wakeUp;
+            Batch pending;
+            Clock::time_point deadline;
+            bool stopping = false;
+            std::thread flusher;
+        };
+
+        //Copies share their batcher, so the calls made through all of them are batched together.
+        template <typename Arg, typename F>
+        class Batched
+        {
+        private:
+            using Result = BatchResult<Arg, F>;
+
+        public:
+            Batched(F f, std::size_t maxBatch, std::chrono::nanoseconds maxDelay)
+                : batcher(std::make_shared<Batcher<Arg, F>>(std::move(f), maxBatch, maxDelay))
+            {
+            }
+
+            //waits for the batch of x to be processed
+            Result operator()(const Arg& x) const { return submit(x).get(); }
+            Result operator()(Arg&& x) const { return submit(std::move(x)).get(); }
+
+            std::future<Result> submit(const Arg& x) const { return batcher->submit(x); }
+            std::future<Result> submit(Arg&& x) const { return batcher->submit(std::move(x)); }
+
+        private:
+            std::shared_ptr<Batcher<Arg, F>> batcher;
+        };
+
+        template <typename F>
+        using BatchArgument = std::remove_cvref_t<typename std::remove_cvref_t<std::tuple_element_t<0, typename CallableTraits<F>::Arguments>>::element_type>;
+    } //namespace Detail
+
+    //A function of a single Arg computed by f(std::span<const Arg>) -> std::vector<R> over the arguments
+    //of many calls, possibly from many threads. A call waits for at most about maxDelay
+    //before its batch is processed, less if maxBatch arguments are collected sooner,
+    //and submit returns a future instead of waiting.
+    template <typename Arg, typename F>
+    auto batched(F f, std::size_t maxBatch, std::chrono::nanoseconds maxDelay)
+    {
+        return Detail::Batched<Arg, F>{ std::move(f), maxBatch, maxDelay };
+    }
+
+    //the same with Arg taken from the span f takes
+    template <typename F,
+              typename = std::enable_if_t<Detail::hasCallableTraits<F>>
+    > auto batched(F f, std::size_t maxBatch, std::chrono::nanoseconds maxDelay)
+    {
+        return batched<Detail::BatchArgument<F>>(std::move(f), maxBatch, maxDelay);
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
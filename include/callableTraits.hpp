@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //Result, Arguments and arity of a callable with a single signature:
+        //functions, pointers to functions and members, and function objects with
+        //a non-overloaded, non-template operator(). Member pointers take the object first.
+        template <typename F, typename = void>
+        struct CallableTraits { };
+
+        template <typename R, typename... Args>
+        struct CallableTraits<R(Args...)>
+        {
+            using Result = R;
+            using Arguments = std::tuple<Args...>;
+            static constexpr std::size_t arity = sizeof...(Args);
+        };
+
+        template <typename R, typename... Args>
+        struct CallableTraits<R(Args...) noexcept> : CallableTraits<R(Args...)> { };
+
+        template <typename R, typename... Args>
+        struct CallableTraits<R(*)(Args...)> : CallableTraits<R(Args...)> { };
+
+        template <typename R, typename... Args>
+        struct CallableTraits<R(*)(Args...) noexcept> : CallableTraits<R(Args...)> { };
+
+        template <typename R, typename C>
+        struct CallableTraits<R C::*, std::enable_if_t<std::is_object_v<R>>> : CallableTraits<const R&(const C&)> { };
+
+        //the signature of a member function with the qualifiers of the object moved to its parameter,
+        //Object is used for pointers to members and Call drops it for operator() of function objects
+        template <typename F>
+        struct MemberSignature { };
+
+#define IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(QUALIFIERS, OBJECT)                              \
+        template <typename R, typename C, typename... Args>                                 \
+        struct MemberSignature<R(C::*)(Args...) QUALIFIERS>                                 \
+        {                                                                                   \
+            using Object = R(C OBJECT, Args...);                                            \
+            using Call = R(Args...);                                                        \
+        };                                                                                  \
+        template <typename R, typename C, typename... Args>                                 \
+        struct MemberSignature<R(C::*)(Args...) QUALIFIERS noexcept>                        \
+            : MemberSignature<R(C::*)(Args...) QUALIFIERS> { };
+
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(, &)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(&, &)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(&&, &&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const, const&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const&, const&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const&&, const&&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(volatile, volatile&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(volatile&, volatile&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(volatile&&, volatile&&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const volatile, const volatile&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const volatile&, const volatile&)
+        IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE(const volatile&&, const volatile&&)
+
+#undef IDRAGNEV_FUNCTIONAL_MEMBER_SIGNATURE
+
+        //a signature MemberSignature cannot split leaves the callable without traits instead of failing
+        template <typename F>
+        struct CallableTraits<F, std::enable_if_t<std::is_member_function_pointer_v<F>, std::void_t<typename MemberSignature<F>::Object>>>
+            : CallableTraits<typename MemberSignature<F>::Object> { };
+
+        template <typename F>
+        struct CallableTraits<F, std::enable_if_t<std::is_class_v<F>, std::void_t<typename MemberSignature<decltype(&F::operator())>::Call>>>
+            : CallableTraits<typename MemberSignature<decltype(&F::operator())>::Call> { };
+
+        template <typename F, typename = void>
+        inline constexpr bool hasCallableTraits = false;
+
+        template <typename F>
+        inline constexpr bool hasCallableTraits<F, std::void_t<typename CallableTraits<F>::Arguments>> = true;
+    } //namespace Detail
+} //namespace IDragnev::Functional
\ No newline at end of file
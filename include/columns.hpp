@@ -0,0 +1,217 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "functional.hpp"
+#include "batch.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename P, typename Q>
+        constexpr bool isSameProjection(const P& lhs, const Q& rhs) noexcept
+        {
+            if constexpr (!std::is_same_v<P, Q>) {
+                return false;
+            }
+            else if constexpr (std::is_member_pointer_v<P> || std::is_pointer_v<P>) {
+                return lhs == rhs;
+            }
+            else {
+                return std::is_empty_v<P>;
+            }
+        }
+
+        //compose(fs...) without its innermost function, which is what a column replaces
+        template <typename... Fs, std::size_t... Is>
+        constexpr auto outerFunctions(const Composed<Fs...>& f, std::index_sequence<Is...>)
+        {
+            if constexpr (sizeof...(Is) == 1) {
+                return std::get<0>(f.functions());
+            }
+            else {
+                using Outer = Composed<std::tuple_element_t<Is, std::tuple<Fs...>>...>;
+                return Outer{ std::get<Is>(f.functions())... };
+            }
+        }
+    } //namespace Detail
+
+    //A structure-of-arrays copy of the given projections of a collection,
+    //the records being objects, pointers or anything else accepted by invoke.
+    //The predicates run over the contiguous columns instead of the records
+    //and their results are positions in the collection the columns were built from.
+    //The columns do not follow the records: changes must be reported with update, pushBack or assign.
+    template <typename Record, typename... Projections>
+    class Columns
+    {
+    private:
+        static_assert(sizeof...(Projections) > 0, "At least one projection must be supplied");
+
+        template <typename P>
+        using Value = std::decay_t<std::invoke_result_t<const P&, const Record&>>;
+
+    public:
+        template <typename Range>
+        Columns(const Range& records, Projections... projections)
+            : projections(std::move(projections)...)
+        {
+            assign(records);
+        }
+
+        template <typename Range>
+        void assign(const Range& records)
+        {
+            std::apply([](auto&... columns) { (columns.clear(), ...); }, data);
+            for (const auto& record : records) {
+                pushBack(record);
+            }
+        }
+
+        void pushBack(const Record& record)
+        {
+            forEachColumn([&record](const auto& projection, auto& column)
+            {
+                column.push_back((invoke)(projection, record));
+            });
+        }
+
+        //rereads the projections of the record at position i
+        void update(std::size_t i, const Record& record)
+        {
+            forEachColumn([i, &record](const auto& projection, auto& column)
+            {
+                column.at(i) = (invoke)(projection, record);
+            });
+        }
+
+        std::size_t size() const noexcept { return std::get<0>(data).size(); }
+
+        //the column of the given projection, which must be one of the projections of the columns
+        template <typename P>
+        auto column(const P& projection) const -> std::span<const Value<P>>
+        {
+            auto result = std::span<const Value<P>>{};
+            auto found = false;
+            forEachColumn([&](const auto& p, const auto& column)
+            {
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(p)>, P>) {
+                    if (!found && Detail::isSameProjection(p, projection)) {
+                        result = column;
+                        found = true;
+                    }
+                }
+            });
+            if (!found) {
+                throw std::invalid_argument{ "The projection is not among the columns" };
+            }
+            return result;
+        }
+
+        //bit i of the result is set when p holds for the record at position i:
+        //p ends with a projection of the columns, as matches(key, projection) does,
+        //and the rest of it runs over the column of that projection
+        template <typename P>
+        Bitmask mask(const P& p) const
+        {
+            return splitByColumn(p, [](const auto& predicate, auto column) { return Detail::maskOf(predicate, column); });
+        }
+
+        template <typename Projection, typename P>
+        Bitmask mask(const Projection& projection, const P& p) const
+        {
+            return Detail::maskOf(p, column(projection));
+        }
+
+        //the positions of the records satisfying p in increasing order
+        template <typename P>
+        std::vector<std::size_t> select(const P& p) const
+        {
+            return mask(p).selection();
+        }
+
+        //the position of the first record satisfying p or size() if there is none
+        template <typename P>
+        std::size_t find(const P& p) const
+        {
+            return splitByColumn(p, [this](const auto& predicate, auto column)
+            {
+                for (auto first = std::size_t{ 0 }; first < column.size(); first += Detail::blockRows) {
+                    const auto block = column.subspan(first, std::min(Detail::blockRows, column.size() - first));
+                    const auto mask = Detail::maskOf(predicate, block);
+                    const auto words = mask.words();
+                    for (auto i = std::size_t{ 0 }; i < words.size(); ++i) {
+                        if (words[i] != 0) {
+                            return first + i * Bitmask::wordBits + std::countr_zero(words[i]);
+                        }
+                    }
+                }
+                return size();
+            });
+        }
+
+        //an iterator to the first of the records satisfying p or their end if there is none,
+        //records being the collection the columns were built from
+        template <typename Range, typename P>
+        auto find(Range& records, const P& p) const
+        {
+            return std::next(std::begin(records), find(p));
+        }
+
+    private:
+        template <typename F>
+        void forEachColumn(F f)
+        {
+            forEachColumn(f, std::index_sequence_for<Projections...>{});
+        }
+
+        template <typename F>
+        void forEachColumn(F f) const
+        {
+            forEachColumn(f, std::index_sequence_for<Projections...>{});
+        }
+
+        template <typename F, std::size_t... Is>
+        void forEachColumn(F& f, std::index_sequence<Is...>)
+        {
+            (f(std::get<Is>(projections), std::get<Is>(data)), ...);
+        }
+
+        template <typename F, std::size_t... Is>
+        void forEachColumn(F& f, std::index_sequence<Is...>) const
+        {
+            (f(std::get<Is>(projections), std::get<Is>(data)), ...);
+        }
+
+        template <typename P, typename F>
+        decltype(auto) splitByColumn(const P& p, F f) const
+        {
+            static_assert(Detail::IsComposed<P>::value,
+                          "The predicate must end with a projection of the columns, as matches(key, projection) does");
+
+            constexpr auto last = std::tuple_size_v<std::remove_cvref_t<decltype(p.functions())>> - 1;
+            const auto& projection = std::get<last>(p.functions());
+            return f(Detail::outerFunctions(p, std::make_index_sequence<last>{}), column(projection));
+        }
+
+        std::tuple<Projections...> projections;
+        std::tuple<std::vector<Value<Projections>>...> data;
+    };
+
+    //columns(records, projections...) copies the projections of records into contiguous columns
+    template <typename Range, typename... Projections>
+    auto columns(const Range& records, Projections... projections)
+    {
+        using Record = std::remove_cvref_t<decltype(*std::begin(records))>;
+        return Columns<Record, Projections...>{ records, std::move(projections)... };
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -1,25 +1,138 @@
 #pragma once
 
 #include "invoke.hpp"
+#include "callableTraits.hpp"
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace IDragnev::Functional
 {
     namespace Detail
     {
-        template <typename Callable, typename... Args>
-        auto curryImpl(Callable f, Args&&... args)
+        template <typename Callable, typename... BoundArgs>
+        class Curried
         {
-            return[f, ...boundArgs = std::forward<decltype(args)>(args)](auto&&... rest) -> decltype(auto)
+        public:
+            template <typename... Args>
+            constexpr Curried(Callable f, Args&&... args)
+                : f(std::move(f)),
+                  boundArgs(std::forward<Args>(args)...)
             {
-                if constexpr (std::is_invocable_v<decltype(f), decltype(boundArgs)..., decltype(rest)...>) {
-                    return (invoke)(f, boundArgs..., std::forward<decltype(rest)>(rest)...);
-                }
-                else {
-                    return curryImpl(f, std::move(boundArgs)..., std::forward<decltype(rest)>(rest)...);
-                }
-            };
-        }
+            }
+
+            //reusing an lvalue curried function copies its bound state
+            template <typename... Rest>
+            constexpr decltype(auto) operator()(Rest&&... rest) const &
+            {
+                return std::apply([this, &rest...](const auto&... bound) -> decltype(auto)
+                {
+                    if constexpr (std::is_invocable_v<const Callable&, decltype(bound)..., Rest...>) {
+                        return (invoke)(f, bound..., std::forward<Rest>(rest)...);
+                    }
+                    else {
+                        return Curried<Callable, BoundArgs..., std::decay_t<Rest>...>{
+                            f, bound..., std::forward<Rest>(rest)...
+                        };
+                    }
+                }, boundArgs);
+            }
+
+            //a temporary curried function moves its bound state to the next stage
+            template <typename... Rest>
+            constexpr decltype(auto) operator()(Rest&&... rest) &&
+            {
+                return std::apply([this, &rest...](auto&... bound) -> decltype(auto)
+                {
+                    if constexpr (std::is_invocable_v<Callable, BoundArgs..., Rest...>) {
+                        return (invoke)(std::move(f), std::move(bound)..., std::forward<Rest>(rest)...);
+                    }
+                    else {
+                        return Curried<Callable, BoundArgs..., std::decay_t<Rest>...>{
+                            std::move(f), std::move(bound)..., std::forward<Rest>(rest)...
+                        };
+                    }
+                }, boundArgs);
+            }
+
+        private:
+            [[no_unique_address]] Callable f;
+            std::tuple<BoundArgs...> boundArgs;
+        };
+
+        //Curried with the number of arguments still missing known up front:
+        //a call with fewer arguments binds them, a call with all of them invokes f,
+        //so there is no is_invocable check on the way
+        template <std::size_t N, typename Callable, typename... BoundArgs>
+        class CurriedN
+        {
+        public:
+            template <typename... Args>
+            constexpr CurriedN(Callable f, Args&&... args)
+                : f(std::move(f)),
+                  boundArgs(std::forward<Args>(args)...)
+            {
+            }
+
+            template <typename... Rest,
+                      typename = std::enable_if_t<(sizeof...(Rest) <= N)>
+            > constexpr decltype(auto) operator()(Rest&&... rest) const &
+            {
+                return std::apply([this, &rest...](const auto&... bound) -> decltype(auto)
+                {
+                    if constexpr (sizeof...(Rest) == N) {
+                        return (invoke)(f, bound..., std::forward<Rest>(rest)...);
+                    }
+                    else {
+                        return CurriedN<N - sizeof...(Rest), Callable, BoundArgs..., std::decay_t<Rest>...>{
+                            f, bound..., std::forward<Rest>(rest)...
+                        };
+                    }
+                }, boundArgs);
+            }
+
+            template <typename... Rest,
+                      typename = std::enable_if_t<(sizeof...(Rest) <= N)>
+            > constexpr decltype(auto) operator()(Rest&&... rest) &&
+            {
+                return std::apply([this, &rest...](auto&... bound) -> decltype(auto)
+                {
+                    if constexpr (sizeof...(Rest) == N) {
+                        return (invoke)(std::move(f), std::move(bound)..., std::forward<Rest>(rest)...);
+                    }
+                    else {
+                        return CurriedN<N - sizeof...(Rest), Callable, BoundArgs..., std::decay_t<Rest>...>{
+                            std::move(f), std::move(bound)..., std::forward<Rest>(rest)...
+                        };
+                    }
+                }, boundArgs);
+            }
+
+        private:
+            [[no_unique_address]] Callable f;
+            std::tuple<BoundArgs...> boundArgs;
+        };
     } //namespace Detail
 
-    inline const auto curry = [](auto f) { return Detail::curryImpl(f); };
+    //curryN<N>(f) invokes f once it has N arguments, which also lets f have
+    //more parameters with default arguments or be overloaded and generic
+    template <std::size_t N>
+    inline constexpr auto curryN = [](auto f)
+    {
+        return Detail::CurriedN<N, decltype(f)>{ std::move(f) };
+    };
+
+    //the arity of functions, member pointers and non-generic lambdas is taken from their signature,
+    //other callables are invoked as soon as they can be
+    inline constexpr auto curry = [](auto f)
+    {
+        using F = decltype(f);
+        if constexpr (Detail::hasCallableTraits<F>) {
+            return curryN<Detail::CallableTraits<F>::arity>(std::move(f));
+        }
+        else {
+            return Detail::Curried<F>{ std::move(f) };
+        }
+    };
 } //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //string literals are ordered by their contents rather than by their addresses
+        template <typename K>
+        using KeyType = std::conditional_t<std::is_same_v<std::decay_t<K>, const char*> ||
+                                           std::is_same_v<std::decay_t<K>, char*>,
+                                           std::string_view,
+                                           std::decay_t<K>>;
+
+        template <typename Key, typename K, std::size_t N, std::size_t... Is>
+        constexpr std::array<Key, N> sortedArray(const K* keys, std::index_sequence<Is...>)
+        {
+            auto result = std::array<Key, N>{ Key(keys[Is])... };
+            std::sort(std::begin(result), std::end(result), std::less<>{});
+            return result;
+        }
+
+        template <typename Key, typename Range>
+        std::vector<Key> sortedVector(const Range& keys)
+        {
+            auto result = std::vector<Key>(std::begin(keys), std::end(keys));
+            std::sort(std::begin(result), std::end(result), std::less<>{});
+            return result;
+        }
+
+        template <typename Keys, typename Extractor>
+        class MatchesAny
+        {
+        public:
+            constexpr MatchesAny(Keys keys, Extractor extractor)
+                : keys(std::move(keys)),
+                  extractor(std::move(extractor))
+            {
+            }
+
+            template <typename... Args>
+            constexpr bool operator()(const Args&... args) const
+            {
+                const auto& key = (invoke)(extractor, args...);
+                return std::binary_search(std::begin(keys), std::end(keys), key, std::less<>{});
+            }
+
+        private:
+            Keys keys;
+            [[no_unique_address]] Extractor extractor;
+        };
+
+        //each key paired with the position of its handler, sorted by key and then by position
+        template <typename Key, typename... Ks>
+        constexpr auto sortedEntries(const Ks&... keys)
+        {
+            using Entry = std::pair<Key, std::size_t>;
+            auto i = std::size_t{ 0 };
+            auto result = std::array<Entry, sizeof...(Ks)>{ Entry{ Key(keys), i++ }... };
+            std::sort(std::begin(result), std::end(result), [](const Entry& lhs, const Entry& rhs)
+            {
+                return std::less<>{}(lhs.first, rhs.first) || (!std::less<>{}(rhs.first, lhs.first) && lhs.second < rhs.second);
+            });
+            return result;
+        }
+
+        template <typename K, typename Handler>
+        struct KeyHandler
+        {
+            K key;
+            [[no_unique_address]] Handler handler;
+        };
+
+        //Every handler is called with the arguments of the dispatcher.
+        //A key registered more than once goes to the first of its handlers.
+        template <typename Extractor, typename Key, typename... Handlers>
+        class Dispatcher
+        {
+        private:
+            static constexpr auto size = sizeof...(Handlers);
+            using Entry = std::pair<Key, std::size_t>;
+
+        public:
+            constexpr Dispatcher(Extractor extractor, std::array<Entry, size> entries, Handlers... handlers)
+                : extractor(std::move(extractor)),
+                  entries(std::move(entries)),
+                  handlers(std::move(handlers)...)
+            {
+            }
+
+            //the result of the handler of the extracted key, or nullopt if there is none:
+            //a bool telling whether there is one when the handlers return void.
+            //common_type decays the results, so handlers returning references give copies
+            template <typename... Args>
+            constexpr auto operator()(Args&&... args) const
+            {
+                using R = std::common_type_t<std::invoke_result_t<const Handlers&, Args...>...>;
+                using Result = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+
+                const auto& key = (invoke)(extractor, std::as_const(args)...);
+                const auto pos = std::lower_bound(std::begin(entries), std::end(entries), key,
+                                                  [](const Entry& entry, const auto& key) { return std::less<>{}(entry.first, key); });
+                if (pos == std::end(entries) || std::less<>{}(key, pos->first)) {
+                    return Result{};
+                }
+
+                using Call = R (*)(const std::tuple<Handlers...>&, Args&&...);
+                constexpr auto table = makeTable<R, Call, Args...>(std::make_index_sequence<size>{});
+                if constexpr (std::is_void_v<R>) {
+                    table[pos->second](handlers, std::forward<Args>(args)...);
+                    return true;
+                }
+                else {
+                    return Result{ table[pos->second](handlers, std::forward<Args>(args)...) };
+                }
+            }
+
+        private:
+            template <typename R, typename Call, typename... Args, std::size_t... Is>
+            static constexpr std::array<Call, size> makeTable(std::index_sequence<Is...>)
+            {
+                return { [](const std::tuple<Handlers...>& handlers, Args&&... args) -> R
+                {
+                    return static_cast<R>((invoke)(std::get<Is>(handlers), std::forward<Args>(args)...));
+                }... };
+            }
+
+            [[no_unique_address]] Extractor extractor;
+            std::array<Entry, size> entries;
+            std::tuple<Handlers...> handlers;
+        };
+    } //namespace Detail
+
+    //matches(k, extractor) for any k of keys, looked up by binary search over the sorted keys.
+    //A fixed set of keys is kept in an array and can be sorted at compile time.
+    template <typename K, std::size_t N, typename Extractor>
+    constexpr auto matchesAny(const K (&keys)[N], Extractor extractor)
+    {
+        using Key = Detail::KeyType<K>;
+        using Keys = std::array<Key, N>;
+        return Detail::MatchesAny<Keys, Extractor>{ Detail::sortedArray<Key, K, N>(keys, std::make_index_sequence<N>{}), std::move(extractor) };
+    }
+
+    template <typename K, std::size_t N, typename Extractor>
+    constexpr auto matchesAny(const std::array<K, N>& keys, Extractor extractor)
+    {
+        using Key = Detail::KeyType<K>;
+        using Keys = std::array<Key, N>;
+        return Detail::MatchesAny<Keys, Extractor>{ Detail::sortedArray<Key, K, N>(keys.data(), std::make_index_sequence<N>{}), std::move(extractor) };
+    }
+
+    template <typename Range, typename Extractor>
+    auto matchesAny(const Range& keys, Extractor extractor)
+    {
+        using Key = Detail::KeyType<decltype(*std::begin(keys))>;
+        using Keys = std::vector<Key>;
+        return Detail::MatchesAny<Keys, Extractor>{ Detail::sortedVector<Key>(keys), std::move(extractor) };
+    }
+
+    template <typename K, typename Handler>
+    constexpr auto onKey(K key, Handler handler)
+    {
+        return Detail::KeyHandler<K, Handler>{ std::move(key), std::move(handler) };
+    }
+
+    //calls the handler registered with onKey for the key extracted from the arguments,
+    //found by binary search over the keys sorted once on construction
+    template <typename Extractor, typename... Ks, typename... Handlers>
+    constexpr auto dispatchOn(Extractor extractor, Detail::KeyHandler<Ks, Handlers>... handlers)
+    {
+        static_assert(sizeof...(Handlers) > 0, "At least one handler must be supplied");
+
+        using Key = std::common_type_t<Detail::KeyType<Ks>...>;
+        return Detail::Dispatcher<Extractor, Key, Handlers...>{ std::move(extractor),
+                                                                Detail::sortedEntries<Key>(handlers.key...),
+                                                                std::move(handlers.handler)... };
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
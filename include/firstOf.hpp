@@ -1,5 +1,9 @@
-#include <type_traits>
+#pragma once
+
 #include "invoke.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
 namespace IDragnev::Functional
 {
@@ -7,49 +11,109 @@ namespace IDragnev::Functional
     {
         struct DeletedT { };
 
-        template <typename... Fs>
-        class FirstOf { };
+        template <typename F, typename... Args>
+        constexpr bool isDeletedFor() noexcept
+        {
+            if constexpr (std::is_invocable_v<F&, Args...>) {
+                return std::is_same_v<std::invoke_result_t<F&, Args...>, DeletedT>;
+            }
+            else {
+                return false;
+            }
+        }
 
-        template <typename... Fs>
-        FirstOf(Fs...) -> FirstOf<Fs...>;
+        template <std::size_t I, typename F>
+        struct Overload
+        {
+            [[no_unique_address]] F f;
+        };
+
+        //the base Overload<I, F> is found by deduction instead of by recursion
+        template <std::size_t I, typename F>
+        constexpr const F& nth(const Overload<I, F>& overload) noexcept
+        {
+            return overload.f;
+        }
 
-        template <typename F, typename... Fs>
-        class FirstOf<F, Fs...>
+        template <typename Indices, typename... Fs>
+        struct OverloadSet;
+
+        template <std::size_t... Is, typename... Fs>
+        struct OverloadSet<std::index_sequence<Is...>, Fs...> : Overload<Is, Fs>...
+        {
+            constexpr OverloadSet(Fs... funs)
+                : Overload<Is, Fs>{ std::move(funs) }...
+            {
+            }
+        };
+
+        //The overload is chosen by a single scan over a flat array of flags and the functions
+        //are stored as the bases of a single class, so that neither the dispatch nor the storage
+        //instantiate templates recursively through the tail.
+        template <typename... Fs>
+        class FirstOf
         {
         private:
-            using Tail = FirstOf<Fs...>;
+            using Overloads = OverloadSet<std::index_sequence_for<Fs...>, Fs...>;
+            static constexpr auto none = sizeof...(Fs);
+
+            template <typename... Args>
+            static constexpr std::size_t firstMatch() noexcept
+            {
+                constexpr bool matches[] = { std::is_invocable_v<const Fs&, Args...>..., false };
+                for (auto i = std::size_t{ 0 }; i < none; ++i) {
+                    if (matches[i]) {
+                        return i;
+                    }
+                }
+                return none;
+            }
+
+            template <std::size_t I, typename... Args>
+            struct Match
+            {
+                using F = decltype(nth<I>(std::declval<const Overloads&>()));
+                using Result = std::invoke_result_t<F, Args...>;
+                static constexpr bool isDeleted = std::is_same_v<Result, DeletedT>;
+                static constexpr bool isNothrow = std::is_nothrow_invocable_v<F, Args...>;
+            };
 
         public:
-            constexpr FirstOf(F first, Fs... tail)
-                : first(std::move(first)),
-                  tail(std::move(tail)...)
+            constexpr FirstOf(Fs... funs)
+                : overloads(std::move(funs)...)
             {
             }
 
-            template <typename... Args,
-                      bool FirstOverloadMatched = std::is_invocable_v<const F&, Args...>,
-                      typename MatchedOverload = const std::conditional_t<FirstOverloadMatched, F, Tail>&,
-                      typename InvokeResult = std::invoke_result_t<MatchedOverload, Args...>,
-                      typename = std::enable_if_t<!std::is_same_v<InvokeResult, DeletedT>>
-            > constexpr InvokeResult operator()(Args&&... args) const
-                noexcept(std::is_nothrow_invocable_v<MatchedOverload, Args...>)
+            //whether a Deleted entry accepting Args comes before the overload handling them
+            template <typename... Args>
+            static constexpr bool isDeleted() noexcept
             {
-                if constexpr (FirstOverloadMatched) {
-                    return (invoke)(first, std::forward<decltype(args)>(args)...);
-                }
-                else {
-                    return (invoke)(tail, std::forward<decltype(args)>(args)...);
+                constexpr bool deleted[] = { isDeletedFor<Fs, Args...>()..., false };
+                constexpr auto match = firstMatch<Args...>();
+                for (auto i = std::size_t{ 0 }; i < match; ++i) {
+                    if (deleted[i]) {
+                        return true;
+                    }
                 }
+                return false;
             }
 
             template <typename... Args,
-                      typename = std::enable_if_t<std::is_same_v<std::invoke_result_t<const F&, Args...>, DeletedT>>
-            > constexpr void operator()(Args&&...) const = delete;
+                      std::size_t I = firstMatch<Args...>(),
+                      typename = std::enable_if_t<(I < none)>,
+                      typename M = Match<I, Args...>,
+                      typename = std::enable_if_t<!M::isDeleted>
+            > constexpr typename M::Result operator()(Args&&... args) const noexcept(M::isNothrow)
+            {
+                return (invoke)(nth<I>(overloads), std::forward<Args>(args)...);
+            }
 
         private:
-            [[no_unique_address]] F first;
-            [[no_unique_address]] Tail tail;
+            [[no_unique_address]] Overloads overloads;
         };
+
+        template <typename... Fs>
+        FirstOf(Fs...) -> FirstOf<Fs...>;
     } // namespace Detail
 
     template <typename F>
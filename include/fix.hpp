@@ -0,0 +1,120 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace IDragnev::Functional
+{
+    //the result of a trampolined computation
+    template <typename T>
+    struct Done
+    {
+        T value;
+    };
+
+    template <typename T>
+    Done(T) -> Done<T>;
+
+    //the arguments of the next step of a trampolined computation
+    template <typename... Args>
+    struct Continue
+    {
+        constexpr Continue(Args... args) noexcept(std::is_nothrow_constructible_v<std::tuple<Args...>, Args&&...>)
+            : args(std::move(args)...)
+        {
+        }
+
+        std::tuple<Args...> args;
+    };
+
+    template <typename... Args>
+    Continue(Args...) -> Continue<Args...>;
+
+    //what a step over Args... returns to a trampoline computing an R
+    template <typename R, typename... Args>
+    using Step = std::variant<Done<R>, Continue<Args...>>;
+
+    namespace Detail
+    {
+        template <typename F>
+        class Fixed
+        {
+        public:
+            constexpr Fixed(F f) noexcept(std::is_nothrow_move_constructible_v<F>)
+                : f(std::move(f))
+            {
+            }
+
+            template <typename... Args>
+            constexpr decltype(auto) operator()(Args&&... args) const
+            {
+                return (invoke)(f, *this, std::forward<Args>(args)...);
+            }
+
+        private:
+            [[no_unique_address]] F f;
+        };
+
+        template <typename S>
+        struct StepTraits
+        {
+            static_assert(sizeof(S) == 0, "A trampolined step must return a Step<R, Args...>");
+        };
+
+        template <typename R, typename... Args>
+        struct StepTraits<std::variant<Done<R>, Continue<Args...>>>
+        {
+            using Result = R;
+            using State = std::tuple<Args...>;
+        };
+
+        //The steps are called in a loop with the state in a local tuple,
+        //so the depth of the computation takes neither stack nor heap.
+        template <typename F>
+        class Trampolined
+        {
+        public:
+            constexpr Trampolined(F f) noexcept(std::is_nothrow_move_constructible_v<F>)
+                : f(std::move(f))
+            {
+            }
+
+            template <typename... Args>
+            constexpr auto operator()(Args&&... args) const
+            {
+                using Traits = StepTraits<std::invoke_result_t<const F&, std::decay_t<Args>...>>;
+                using State = typename Traits::State;
+
+                auto state = State{ std::forward<Args>(args)... };
+                while (true) {
+                    auto step = std::apply([this](auto&&... xs) { return (invoke)(f, std::move(xs)...); }, std::move(state));
+                    if (auto* done = std::get_if<0>(&step)) {
+                        return typename Traits::Result(std::move(done->value));
+                    }
+                    state = std::move(std::get<1>(step).args);
+                }
+            }
+
+        private:
+            [[no_unique_address]] F f;
+        };
+    } //namespace Detail
+
+    //fix(f)(args...) calls f(self, args...) with self being fix(f) itself,
+    //so that lambdas can recurse. f returning auto must return a non-recursive result first.
+    inline constexpr auto fix = [](auto f) noexcept(std::is_nothrow_copy_constructible_v<decltype(f)>)
+    {
+        return Detail::Fixed<decltype(f)>{ std::move(f) };
+    };
+
+    //trampoline(step)(args...) calls step with args, then with the arguments of each Continue
+    //it returns, until it returns a Done with the result. Tail-recursive algorithms
+    //written as steps run in a loop, however many steps they take.
+    inline constexpr auto trampoline = [](auto step) noexcept(std::is_nothrow_copy_constructible_v<decltype(step)>)
+    {
+        return Detail::Trampolined<decltype(step)>{ std::move(step) };
+    };
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //invoke with the result converted to R, or discarded when R is void
+        template <typename R, typename F, typename... Args>
+        constexpr R invokeR(F&& f, Args&&... args)
+        {
+            if constexpr (std::is_void_v<R>) {
+                (invoke)(std::forward<F>(f), std::forward<Args>(args)...);
+            }
+            else {
+                return (invoke)(std::forward<F>(f), std::forward<Args>(args)...);
+            }
+        }
+    } //namespace Detail
+
+    inline constexpr std::size_t defaultInlineBytes = 64;
+
+    //whether Function<Sig, InlineBytes> stores F in place instead of on the heap
+    template <typename F, std::size_t InlineBytes = defaultInlineBytes>
+    inline constexpr bool fitsInline = sizeof(F) <= InlineBytes &&
+                                       alignof(F) <= alignof(std::max_align_t) &&
+                                       std::is_nothrow_move_constructible_v<F>;
+
+    template <typename Signature, std::size_t InlineBytes = defaultInlineBytes>
+    class Function;
+
+    //A move-only owner of any callable with the given signature.
+    //Callables for which fitsInline holds are stored in the object itself,
+    //the rest are allocated and the object holds a pointer to them.
+    //As with std::function, a const Function calls its callable as a non-const lvalue.
+    template <typename R, typename... Args, std::size_t InlineBytes>
+    class Function<R(Args...), InlineBytes>
+    {
+    private:
+        struct VTable
+        {
+            R (*call)(void* storage, Args&&... args);
+            void (*move)(void* from, void* to) noexcept;
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename F>
+        struct Inline
+        {
+            static F& get(void* storage) noexcept { return *std::launder(static_cast<F*>(storage)); }
+
+            static R call(void* storage, Args&&... args)
+            {
+                return Detail::invokeR<R>(get(storage), std::forward<Args>(args)...);
+            }
+
+            static void move(void* from, void* to) noexcept
+            {
+                ::new (to) F(std::move(get(from)));
+                get(from).~F();
+            }
+
+            static void destroy(void* storage) noexcept { get(storage).~F(); }
+
+            static constexpr auto vtable = VTable{ &call, &move, &destroy };
+        };
+
+        template <typename F>
+        struct Allocated
+        {
+            static F*& get(void* storage) noexcept { return *std::launder(static_cast<F**>(storage)); }
+
+            static R call(void* storage, Args&&... args)
+            {
+                return Detail::invokeR<R>(*get(storage), std::forward<Args>(args)...);
+            }
+
+            static void move(void* from, void* to) noexcept { ::new (to) F*(get(from)); }
+            static void destroy(void* storage) noexcept { delete get(storage); }
+
+            static constexpr auto vtable = VTable{ &call, &move, &destroy };
+        };
+
+        template <typename F>
+        static constexpr bool isCompatible = !std::is_same_v<std::decay_t<F>, Function> &&
+                                             std::is_invocable_r_v<R, std::decay_t<F>&, Args...>;
+
+    public:
+        static_assert(InlineBytes >= sizeof(void*), "The buffer must be able to hold a pointer");
+
+        Function() noexcept = default;
+        Function(std::nullptr_t) noexcept { }
+
+        template <typename F,
+                  typename = std::enable_if_t<isCompatible<F>>
+        > Function(F&& f)
+        {
+            using Callable = std::decay_t<F>;
+            if constexpr (std::is_pointer_v<Callable> || std::is_member_pointer_v<Callable>) {
+                if (f == nullptr) {
+                    return;
+                }
+            }
+            if constexpr (fitsInline<Callable, InlineBytes>) {
+                ::new (static_cast<void*>(storage)) Callable(std::forward<F>(f));
+                vtable = &Inline<Callable>::vtable;
+            }
+            else {
+                ::new (static_cast<void*>(storage)) Callable*(new Callable(std::forward<F>(f)));
+                vtable = &Allocated<Callable>::vtable;
+            }
+        }
+
+        Function(Function&& source) noexcept
+            : vtable(std::exchange(source.vtable, nullptr))
+        {
+            if (vtable) {
+                vtable->move(source.storage, storage);
+            }
+        }
+
+        Function& operator=(Function&& rhs) noexcept
+        {
+            if (this != &rhs) {
+                reset();
+                if (rhs.vtable) {
+                    rhs.vtable->move(rhs.storage, storage);
+                    vtable = std::exchange(rhs.vtable, nullptr);
+                }
+            }
+            return *this;
+        }
+
+        Function& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        ~Function() { reset(); }
+
+        R operator()(Args... args) const
+        {
+            assert(vtable != nullptr);
+            return vtable->call(storage, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept { return vtable != nullptr; }
+
+    private:
+        void reset() noexcept
+        {
+            if (vtable) {
+                std::exchange(vtable, nullptr)->destroy(storage);
+            }
+        }
+
+        const VTable* vtable = nullptr;
+        alignas(std::max_align_t) mutable std::byte storage[InlineBytes];
+    };
+
+    template <typename Signature>
+    class FunctionRef;
+
+    //A non-owning view of a callable with the given signature, two pointers in size.
+    //The callable must outlive the view, which is meant for parameters.
+    template <typename R, typename... Args>
+    class FunctionRef<R(Args...)>
+    {
+    private:
+        union Target
+        {
+            void* object;
+            void (*function)();
+        };
+
+        template <typename F>
+        static constexpr bool isCompatible = !std::is_same_v<std::remove_cvref_t<F>, FunctionRef> &&
+                                             std::is_invocable_r_v<R, F&, Args...>;
+
+    public:
+        template <typename F,
+                  typename = std::enable_if_t<isCompatible<F>>
+        > FunctionRef(F&& f) noexcept
+        {
+            using Callable = std::remove_reference_t<F>;
+            if constexpr (std::is_function_v<Callable>) {
+                target.function = reinterpret_cast<void (*)()>(&f);
+                call = [](Target target, Args&&... args) -> R
+                {
+                    return Detail::invokeR<R>(reinterpret_cast<Callable*>(target.function), std::forward<Args>(args)...);
+                };
+            }
+            else if constexpr (std::is_pointer_v<Callable> && std::is_function_v<std::remove_pointer_t<Callable>>) {
+                assert(f != nullptr);
+                target.function = reinterpret_cast<void (*)()>(f);
+                call = [](Target target, Args&&... args) -> R
+                {
+                    return Detail::invokeR<R>(reinterpret_cast<std::remove_const_t<Callable>>(target.function), std::forward<Args>(args)...);
+                };
+            }
+            else {
+                target.object = const_cast<void*>(static_cast<const volatile void*>(std::addressof(f)));
+                call = [](Target target, Args&&... args) -> R
+                {
+                    return Detail::invokeR<R>(*static_cast<Callable*>(target.object), std::forward<Args>(args)...);
+                };
+            }
+        }
+
+        R operator()(Args... args) const
+        {
+            return call(target, std::forward<Args>(args)...);
+        }
+
+    private:
+        Target target;
+        R (*call)(Target target, Args&&... args);
+    };
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "invoke.hpp"
 #include "curry.hpp"
 #include "firstOf.hpp"
+#include "section.hpp"
+#include <cstddef>
+#include <functional>
+#include <tuple>
 #include <utility>
 
 namespace IDragnev::Functional
@@ -30,95 +34,486 @@ namespace IDragnev::Functional
         inline constexpr bool areNothrowCopyConstructible = andAll(std::is_nothrow_copy_constructible_v<Ts>...);
     } //namespace Detail
 
+    //superpose(lastUseMoves, f, g, gs...) lets the last of the functions receive
+    //the arguments as they were given to the superposition, rvalues included
+    inline constexpr struct LastUseMoves { } lastUseMoves;
+
+    namespace Detail
+    {
+        //All the functions but the last see the arguments as const lvalues.
+        //When the last use may move, the last function is called after the others
+        //with the arguments forwarded, and the results of the others are moved to F.
+        template <bool lastUseMoves, typename F, typename... Gs>
+        class Superposed
+        {
+        private:
+            static constexpr auto last = sizeof...(Gs) - 1;
+
+            template <std::size_t I>
+            using Nth = std::tuple_element_t<I, std::tuple<Gs...>>;
+
+        public:
+            constexpr Superposed(F f, Gs... funs) noexcept(andAll(std::is_nothrow_move_constructible_v<F>,
+                                                                  std::is_nothrow_move_constructible_v<Gs>...))
+                : f(std::move(f)),
+                  funs(std::move(funs)...)
+            {
+            }
+
+            template <typename... Args>
+            constexpr decltype(auto) operator()(Args&&... args) const
+            {
+                if constexpr (lastUseMoves) {
+                    return callMovingLast(std::make_index_sequence<last>{}, std::forward<Args>(args)...);
+                }
+                else {
+                    static_assert(andAll(std::is_invocable_v<const Gs&, const std::remove_reference_t<Args>&...>...),
+                                  "Incompatible arguments given to Gs or their signatures are incompatible");
+                    static_assert(std::is_invocable_v<const F&, std::invoke_result_t<const Gs&, const std::remove_reference_t<Args>&...>...>,
+                                  "F and Gs have incompatible signatures");
+                    return std::apply([this, &args...](const auto&... gs) -> decltype(auto)
+                    {
+                        return (invoke)(f, (invoke)(gs, std::as_const(args)...)...);
+                    }, funs);
+                }
+            }
+
+            //f, which receives the results of the others
+            constexpr const F& function() const noexcept { return f; }
+
+            //the functions whose results f receives, in the order they were given to superpose
+            constexpr const std::tuple<Gs...>& functions() const noexcept { return funs; }
+
+        private:
+            template <std::size_t... Is, typename... Args>
+            constexpr decltype(auto) callMovingLast(std::index_sequence<Is...>, Args&&... args) const
+            {
+                static_assert(andAll(true, std::is_invocable_v<const Nth<Is>&, const std::remove_reference_t<Args>&...>...) &&
+                              std::is_invocable_v<const Nth<last>&, Args...>,
+                              "Incompatible arguments given to Gs or their signatures are incompatible");
+
+                using Results = std::tuple<std::invoke_result_t<const Nth<Is>&, const std::remove_reference_t<Args>&...>...>;
+                static_assert(std::is_invocable_v<const F&, std::tuple_element_t<Is, Results>..., std::invoke_result_t<const Nth<last>&, Args...>>,
+                              "F and Gs have incompatible signatures");
+
+                //the braced initialization runs the functions from left to right
+                auto results = Results{ (invoke)(std::get<Is>(funs), std::as_const(args)...)... };
+                return (invoke)(f,
+                                std::forward<std::tuple_element_t<Is, Results>>(std::get<Is>(results))...,
+                                (invoke)(std::get<last>(funs), std::forward<Args>(args)...));
+            }
+
+            [[no_unique_address]] F f;
+            [[no_unique_address]] std::tuple<Gs...> funs;
+        };
+
+        template <typename T>
+        struct IsSuperposed : std::false_type { };
+
+        template <bool lastUseMoves, typename F, typename... Gs>
+        struct IsSuperposed<Superposed<lastUseMoves, F, Gs...>> : std::true_type { };
+    } //namespace Detail
+
     template <typename F>
     F superpose(F&&) = delete;
 
     template <typename F, typename... Gs>
     constexpr inline
     auto superpose(F f, Gs... funs) noexcept(Detail::areNothrowCopyConstructible<F, Gs...>)
+    {
+        return Detail::Superposed<false, F, Gs...>{ std::move(f), std::move(funs)... };
+    }
+
+    template <typename F, typename G, typename... Gs>
+    constexpr auto superpose(LastUseMoves, F f, G g, Gs... funs) noexcept(Detail::areNothrowCopyConstructible<F, G, Gs...>)
+    {
+        return Detail::Superposed<true, F, G, Gs...>{ std::move(f), std::move(g), std::move(funs)... };
+    }
+
+    namespace Detail
+    {
+        inline constexpr auto makeThunk = [](const auto& f, const auto&... args) constexpr noexcept
+        {
+            return[&f, &args...]() constexpr noexcept(std::is_nothrow_invocable_v<decltype(f), decltype(args)...>)
+            -> decltype(auto)
+            {
+                return (invoke)(f, args...);
+            };
+        };
+    } //namespace Detail
+
+    //F receives nullary functions computing the results of Gs on demand,
+    //they refer to the arguments and must not outlive the call
+    template <typename F, typename... Gs>
+    constexpr auto superposeLazy(F f, Gs... funs) noexcept(Detail::areNothrowCopyConstructible<F, Gs...>)
     {
         return[f, funs...](const auto&... args) constexpr -> decltype(auto)
         {
             using Detail::andAll;
             static_assert(andAll(std::is_invocable_v<decltype(funs), decltype(args)...>...),
                           "Incompatible arguments given to Gs or their signatures are incompatible");
-            static_assert(std::is_invocable_v<decltype(f), std::invoke_result_t<decltype(funs), decltype(args)...>...>,
-                          "F and Gs have incompatible signatures");
 
-            return (invoke)(f, (invoke)(funs, args...)...);
+            return (invoke)(f, Detail::makeThunk(funs, args...)...);
         };
     }
 
-    template <typename F, typename G>
-    constexpr auto compose(F f, G g) noexcept(Detail::areNothrowCopyConstructible<F, G>)
+    namespace Detail
     {
-        return[f, g](auto&&... args) constexpr -> decltype(auto)
+        template <typename... Fs>
+        class Composed
         {
-            static_assert(std::is_invocable_v<decltype(g), decltype(args)...>,
-                          "Incompatible arguments given to G");
-            static_assert(std::is_invocable_v<decltype(f), std::invoke_result_t<decltype(g), decltype(args)...>>,
-                          "F and G have incompatible signatures");
+        private:
+            static constexpr auto last = sizeof...(Fs) - 1;
+
+            template <std::size_t I>
+            using Nth = std::tuple_element_t<I, std::tuple<Fs...>>;
+
+            template <std::size_t I, typename... Args>
+            static constexpr bool isCallable() noexcept
+            {
+                if constexpr (!std::is_invocable_v<const Nth<I>&, Args...>) {
+                    return false;
+                }
+                else if constexpr (I == 0) {
+                    return true;
+                }
+                else {
+                    return isCallable<I - 1, std::invoke_result_t<const Nth<I>&, Args...>>();
+                }
+            }
+
+            template <std::size_t I, typename... Args>
+            static constexpr bool isNothrowCallable() noexcept
+            {
+                if constexpr (!std::is_nothrow_invocable_v<const Nth<I>&, Args...>) {
+                    return false;
+                }
+                else if constexpr (I == 0) {
+                    return true;
+                }
+                else {
+                    return isNothrowCallable<I - 1, std::invoke_result_t<const Nth<I>&, Args...>>();
+                }
+            }
 
-            return (invoke)(f, (invoke)(g, std::forward<decltype(args)>(args)...));
+        public:
+            constexpr Composed(Fs... funs) noexcept(andAll(std::is_nothrow_move_constructible_v<Fs>...))
+                : funs(std::move(funs)...)
+            {
+            }
+
+            //takes part in overload resolution only for the arguments the chain accepts
+            template <typename... Args,
+                      typename = std::enable_if_t<isCallable<last, Args...>()>
+            > constexpr decltype(auto) operator()(Args&&... args) const
+                noexcept(isNothrowCallable<last, Args...>())
+            {
+                return call<last>(std::forward<Args>(args)...);
+            }
+
+            //in the order they were given to compose, the outermost first
+            constexpr const std::tuple<Fs...>& functions() const noexcept { return funs; }
+
+        private:
+            //the result of each function is passed down as an argument
+            //so that temporaries live until the outermost function returns
+            template <std::size_t I, typename... Args>
+            constexpr decltype(auto) call(Args&&... args) const
+            {
+                if constexpr (I == 0) {
+                    return (invoke)(std::get<I>(funs), std::forward<Args>(args)...);
+                }
+                else {
+                    return call<I - 1>((invoke)(std::get<I>(funs), std::forward<Args>(args)...));
+                }
+            }
+
+            [[no_unique_address]] std::tuple<Fs...> funs;
         };
-    }
 
-    template <typename F, typename G>
-    inline constexpr auto operator*(F&& f, G&& g) noexcept(noexcept(compose(f, g))) 
+        template <typename T>
+        struct IsComposed : std::false_type { };
+
+        template <typename... Fs>
+        struct IsComposed<Composed<Fs...>> : std::true_type { };
+
+        //specialized by the placeholder expressions, for which * multiplies
+        template <typename T>
+        struct IsExpression : std::false_type { };
+
+        template <typename F, typename G>
+        inline constexpr bool areComposable = !IsExpression<std::remove_cvref_t<F>>::value &&
+                                              !IsExpression<std::remove_cvref_t<G>>::value;
+    } //namespace Detail
+
+    template <typename F, typename G, typename... Gs>
+    constexpr auto compose(F f, G g, Gs... funs) noexcept(Detail::areNothrowCopyConstructible<F, G, Gs...>)
     {
-        return compose(std::forward<F>(f), std::forward<G>(g));
+        return Detail::Composed<F, G, Gs...>{ std::move(f), std::move(g), std::move(funs)... };
     }
 
-    template <typename F, typename G, typename... Gs>
-    constexpr auto compose(F f, G g, Gs... funs) noexcept(noexcept(((f * g) * ... * funs)))
+    template <typename F, typename G,
+              typename = std::enable_if_t<Detail::areComposable<F, G>>
+    > inline constexpr auto operator*(F&& f, G&& g) noexcept(noexcept(compose(f, g)))
     {
-        return ((f * g) * ... * funs);
+        return compose(std::forward<F>(f), std::forward<G>(g));
     }
 
-    inline constexpr auto inverse = [](auto predicate) noexcept(std::is_nothrow_copy_constructible_v<decltype(predicate)>)
+    //allOf(blockwise, ps...) and anyOf(blockwise, ps...) evaluate all of their predicates
+    //and combine the results with & and | instead of && and ||, which avoids branching on each one
+    inline constexpr struct Blockwise { } blockwise;
+
+    namespace Detail
     {
-        return[predicate](auto&&... args) noexcept(std::is_nothrow_invocable_v<decltype(predicate), decltype(args)...>)
+        template <typename P>
+        class Inverse
+        {
+        public:
+            constexpr Inverse(P predicate) noexcept(std::is_nothrow_move_constructible_v<P>)
+                : p(std::move(predicate))
+            {
+            }
+
+            template <typename... Args>
+            constexpr bool operator()(Args&&... args) const
+                noexcept(std::is_nothrow_invocable_v<const P&, Args...>)
+            {
+                return !(invoke)(p, std::forward<Args>(args)...);
+            }
+
+            template <typename In>
+            auto mask(const In& in) const
+            {
+                return BatchKernels<In>::maskInverse(p, in);
+            }
+
+            constexpr const P& predicate() const noexcept { return p; }
+
+        private:
+            [[no_unique_address]] P p;
+        };
+
+        template <typename F>
+        class Flipped
         {
-            return !predicate(std::forward<decltype(args)>(args)...);
+        public:
+            constexpr Flipped(F f) noexcept(std::is_nothrow_move_constructible_v<F>)
+                : f(std::move(f))
+            {
+            }
+
+            template <typename X, typename Y>
+            constexpr decltype(auto) operator()(X&& x, Y&& y) const
+                noexcept(std::is_nothrow_invocable_v<const F&, Y, X>)
+            {
+                return (invoke)(f, std::forward<Y>(y), std::forward<X>(x));
+            }
+
+            constexpr const F& function() const noexcept { return f; }
+
+        private:
+            [[no_unique_address]] F f;
         };
+    } //namespace Detail
+
+    inline constexpr auto inverse = [](auto predicate) noexcept(std::is_nothrow_copy_constructible_v<decltype(predicate)>)
+    {
+        return Detail::Inverse<decltype(predicate)>{ std::move(predicate) };
     };
 
-    inline constexpr auto flip = [](auto f) noexcept
+    inline constexpr auto flip = [](auto f) noexcept(std::is_nothrow_copy_constructible_v<decltype(f)>)
     {
-        return[f](auto&& x, auto&& y) constexpr noexcept(std::is_invocable_v<decltype(f), decltype(y), decltype(x)>)
-        -> decltype(auto)
-        {
-            using X = decltype(x);
-            using Y = decltype(y);
-            return (invoke)(f, std::forward<Y>(y), std::forward<X>(x));
-        };
+        return Detail::Flipped<decltype(f)>{ std::move(f) };
     };
 
     namespace Detail
     {
-        inline constexpr auto makePredicateCombinator = [](auto op) noexcept(std::is_nothrow_copy_constructible_v<decltype(op)>)
+        //Per row, the predicates are evaluated from left to right, stopping as soon as
+        //the result is known unless isBlockwise. mask evaluates them over whole blocks of rows.
+        template <bool isBlockwise, typename... Ps>
+        class AllOf
         {
-            return[op](auto... predicates) constexpr noexcept(noexcept(superpose(op, predicates...)))
+        public:
+            constexpr AllOf(Ps... predicates) noexcept(andAll(std::is_nothrow_move_constructible_v<Ps>...))
+                : predicates(std::move(predicates)...)
             {
-                return superpose(op, predicates...);
-            };
+            }
+
+            template <typename... Args>
+            constexpr bool operator()(const Args&... args) const
+                noexcept(andAll(std::is_nothrow_invocable_v<const Ps&, const Args&...>...))
+            {
+                return std::apply([&args...](const auto&... ps)
+                {
+                    if constexpr (isBlockwise) {
+                        return (true & ... & static_cast<bool>((invoke)(ps, args...)));
+                    }
+                    else {
+                        return (static_cast<bool>((invoke)(ps, args...)) && ...);
+                    }
+                }, predicates);
+            }
+
+            //bit i of the result is set when all of the predicates hold for in[i]
+            template <typename In>
+            auto mask(const In& in) const
+            {
+                return BatchKernels<In>::maskAll(predicates, in);
+            }
+
+        private:
+            [[no_unique_address]] std::tuple<Ps...> predicates;
         };
+
+        template <bool isBlockwise, typename... Ps>
+        class AnyOf
+        {
+        public:
+            constexpr AnyOf(Ps... predicates) noexcept(andAll(std::is_nothrow_move_constructible_v<Ps>...))
+                : predicates(std::move(predicates)...)
+            {
+            }
+
+            template <typename... Args>
+            constexpr bool operator()(const Args&... args) const
+                noexcept(andAll(std::is_nothrow_invocable_v<const Ps&, const Args&...>...))
+            {
+                return std::apply([&args...](const auto&... ps)
+                {
+                    if constexpr (isBlockwise) {
+                        return (false | ... | static_cast<bool>((invoke)(ps, args...)));
+                    }
+                    else {
+                        return (static_cast<bool>((invoke)(ps, args...)) || ...);
+                    }
+                }, predicates);
+            }
+
+            //bit i of the result is set when any of the predicates holds for in[i]
+            template <typename In>
+            auto mask(const In& in) const
+            {
+                return BatchKernels<In>::maskAny(predicates, in);
+            }
+
+        private:
+            [[no_unique_address]] std::tuple<Ps...> predicates;
+        };
+
+        template <template <bool, typename...> typename Combination, typename... Ps>
+        constexpr auto combine(Ps... predicates) noexcept(areNothrowCopyConstructible<Ps...>)
+        {
+            return Combination<false, Ps...>{ std::move(predicates)... };
+        }
+
+        template <template <bool, typename...> typename Combination, typename... Ps>
+        constexpr auto combine(Blockwise, Ps... predicates) noexcept(areNothrowCopyConstructible<Ps...>)
+        {
+            return Combination<true, Ps...>{ std::move(predicates)... };
+        }
     } //namespace Detail
 
-    inline constexpr auto allOf = Detail::makePredicateCombinator(Detail::andAll);
-    inline constexpr auto anyOf = Detail::makePredicateCombinator(Detail::orAll);
+    //the predicates are evaluated from left to right and the evaluation stops
+    //as soon as the result is known, as with the built-in && and ||,
+    //unless the first argument is blockwise
+    inline constexpr auto allOf = [](auto... predicates) constexpr noexcept(Detail::areNothrowCopyConstructible<decltype(predicates)...>)
+    {
+        return Detail::combine<Detail::AllOf>(std::move(predicates)...);
+    };
+
+    inline constexpr auto anyOf = [](auto... predicates) constexpr noexcept(Detail::areNothrowCopyConstructible<decltype(predicates)...>)
+    {
+        return Detail::combine<Detail::AnyOf>(std::move(predicates)...);
+    };
+
     inline constexpr auto noneOf = compose(inverse, anyOf);
 
-    inline const auto bindFront = [](auto f, auto&&... args) 
+    namespace Detail
     {
-        return[f, ...bound = std::forward<decltype(args)>(args)](auto&&... rest) -> decltype(auto)
+        template <typename F, typename... Bound>
+        class BoundFront
         {
-            static_assert(std::is_invocable_v<decltype(f), decltype(bound)..., decltype(rest)...>,
-                          "Incompatible arguments supplied");
-            return (invoke)(f, bound..., std::forward<decltype(rest)>(rest)...);
+        public:
+            template <typename... Args>
+            constexpr BoundFront(F f, Args&&... args)
+                : f(std::move(f)),
+                  bound(std::forward<Args>(args)...)
+            {
+            }
+
+            template <typename... Rest>
+            constexpr decltype(auto) operator()(Rest&&... rest) const &
+            {
+                static_assert(std::is_invocable_v<const F&, const Bound&..., Rest...>,
+                              "Incompatible arguments supplied");
+                return std::apply([this, &rest...](const auto&... args) -> decltype(auto)
+                {
+                    return (invoke)(f, args..., std::forward<Rest>(rest)...);
+                }, bound);
+            }
+
+            //a one-shot call which hands the bound arguments over to f
+            template <typename... Rest>
+            constexpr decltype(auto) operator()(Rest&&... rest) &&
+            {
+                static_assert(std::is_invocable_v<F, Bound..., Rest...>,
+                              "Incompatible arguments supplied");
+                return std::apply([this, &rest...](auto&... args) -> decltype(auto)
+                {
+                    return (invoke)(std::move(f), std::move(args)..., std::forward<Rest>(rest)...);
+                }, bound);
+            }
+
+        private:
+            [[no_unique_address]] F f;
+            std::tuple<Bound...> bound;
         };
+
+        template <typename F, typename... Ts>
+        class BoundFrontRef
+        {
+        public:
+            constexpr BoundFrontRef(F f, Ts&... args)
+                : f(std::move(f)),
+                  bound(args...)
+            {
+            }
+
+            template <typename... Rest>
+            constexpr decltype(auto) operator()(Rest&&... rest) const
+            {
+                static_assert(std::is_invocable_v<const F&, Ts&..., Rest...>,
+                              "Incompatible arguments supplied");
+                return std::apply([this, &rest...](auto... refs) -> decltype(auto)
+                {
+                    return (invoke)(f, refs.get()..., std::forward<Rest>(rest)...);
+                }, bound);
+            }
+
+        private:
+            [[no_unique_address]] F f;
+            std::tuple<std::reference_wrapper<Ts>...> bound;
+        };
+    } //namespace Detail
+
+    inline constexpr auto bindFront = [](auto f, auto&&... args)
+    {
+        using F = decltype(f);
+        return Detail::BoundFront<F, std::decay_t<decltype(args)>...>{ std::move(f), std::forward<decltype(args)>(args)... };
     };
 
+    //binds references to the arguments instead of copies, so the arguments must outlive the result.
+    //Only temporaries are rejected: the result of binding a named local which goes out of scope
+    //before the result is called, e.g. one returned from the function declaring the local or stored
+    //in a closure that outlives it, dangles silently, just like std::ref would
+    template <typename F, typename... Args>
+    constexpr auto bindFrontRef(F f, Args&&... args)
+    {
+        static_assert(Detail::andAll(std::is_lvalue_reference_v<Args>...),
+                      "Temporaries cannot be bound by reference");
+        return Detail::BoundFrontRef<F, std::remove_reference_t<Args>...>{ std::move(f), args... };
+    }
+
     inline const auto bindFirst = [](auto&& f, auto&& arg)
     {
         using F = decltype(f);
@@ -126,25 +521,20 @@ namespace IDragnev::Functional
         return bindFront(std::forward<F>(f), std::forward<Arg>(arg));
     };
 
-    namespace Detail
-    {
-        inline const auto makeBinaryFunctionRightArgumentBinder = compose(curry(bindFirst), flip);
-    } //namespace Detail
-
-    inline const auto plus = Detail::makeBinaryFunctionRightArgumentBinder(std::plus{});
-    inline const auto minus = Detail::makeBinaryFunctionRightArgumentBinder(std::minus{});
-    inline const auto times = Detail::makeBinaryFunctionRightArgumentBinder(std::multiplies{});
-    inline const auto divided = Detail::makeBinaryFunctionRightArgumentBinder(std::divides{});
-    inline const auto mod = Detail::makeBinaryFunctionRightArgumentBinder(std::modulus{});
+    inline constexpr auto plus = Detail::RightSectionBinder<std::plus<>>{};
+    inline constexpr auto minus = Detail::RightSectionBinder<std::minus<>>{};
+    inline constexpr auto times = Detail::RightSectionBinder<std::multiplies<>>{};
+    inline constexpr auto divided = Detail::RightSectionBinder<std::divides<>>{};
+    inline constexpr auto mod = Detail::RightSectionBinder<std::modulus<>>{};
 
-    inline const auto equals = Detail::makeBinaryFunctionRightArgumentBinder(std::equal_to{});
-    inline const auto differs = Detail::makeBinaryFunctionRightArgumentBinder(std::not_equal_to{});
-    inline const auto lessThan = Detail::makeBinaryFunctionRightArgumentBinder(std::less{});
-    inline const auto greaterThan = Detail::makeBinaryFunctionRightArgumentBinder(std::greater{});
-    inline const auto greaterOrEqualTo = Detail::makeBinaryFunctionRightArgumentBinder(std::greater_equal{});
-    inline const auto lessOrEqualTo = Detail::makeBinaryFunctionRightArgumentBinder(std::less_equal{});
+    inline constexpr auto equals = Detail::RightSectionBinder<std::equal_to<>>{};
+    inline constexpr auto differs = Detail::RightSectionBinder<std::not_equal_to<>>{};
+    inline constexpr auto lessThan = Detail::RightSectionBinder<std::less<>>{};
+    inline constexpr auto greaterThan = Detail::RightSectionBinder<std::greater<>>{};
+    inline constexpr auto greaterOrEqualTo = Detail::RightSectionBinder<std::greater_equal<>>{};
+    inline constexpr auto lessOrEqualTo = Detail::RightSectionBinder<std::less_equal<>>{};
 
-    inline const auto matches = [](auto key, auto keyExtractor)
+    inline constexpr auto matches = [](auto key, auto keyExtractor)
     {
         return compose(equals(std::move(key)), keyExtractor);
     };
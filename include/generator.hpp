@@ -0,0 +1,316 @@
+#pragma once
+
+#include "pipeline.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+//GCC matches the name of the allocation function with that of the deallocation function
+//and so takes the sized operator delete, which frees frames from any operator new of the promise,
+//as mismatched with the allocator-taking templates. The coroutines taking std::allocator_arg
+//are defined between these, which keep -Wmismatched-new-delete quiet for them.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#define IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_BEGIN \
+    _Pragma("GCC diagnostic push")                      \
+    _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+#define IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_END _Pragma("GCC diagnostic pop")
+#else
+#define IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_BEGIN
+#define IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_END
+#endif
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //The frame of a coroutine is followed by a pointer to the function releasing it
+        //and by a copy of the allocator it came from, so the same promise type
+        //can work with any allocator given to the coroutine.
+        class FrameAllocation
+        {
+        private:
+            using Release = void (*)(void* frame, std::size_t size) noexcept;
+
+            struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Block
+            {
+                std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+            };
+
+            template <typename Alloc>
+            using BlockAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+
+            static constexpr std::size_t roundUp(std::size_t n, std::size_t alignment) noexcept
+            {
+                return (n + alignment - 1) / alignment * alignment;
+            }
+
+            static constexpr std::size_t releaseOffset(std::size_t frameSize) noexcept
+            {
+                return roundUp(frameSize, alignof(Release));
+            }
+
+            template <typename Alloc>
+            static constexpr std::size_t allocatorOffset(std::size_t frameSize) noexcept
+            {
+                return roundUp(releaseOffset(frameSize) + sizeof(Release), alignof(Alloc));
+            }
+
+            template <typename Alloc>
+            static constexpr std::size_t blocksFor(std::size_t frameSize) noexcept
+            {
+                return (allocatorOffset<Alloc>(frameSize) + sizeof(Alloc) + sizeof(Block) - 1) / sizeof(Block);
+            }
+
+            template <typename Alloc>
+            static void release(void* frame, std::size_t size) noexcept
+            {
+                auto* bytes = static_cast<std::byte*>(frame);
+                auto* stored = std::launder(reinterpret_cast<Alloc*>(bytes + allocatorOffset<Alloc>(size)));
+                auto alloc = std::move(*stored);
+                stored->~Alloc();
+                std::allocator_traits<Alloc>::deallocate(alloc, static_cast<Block*>(frame), blocksFor<Alloc>(size));
+            }
+
+        public:
+            template <typename Alloc>
+            static void* allocate(std::size_t size, const Alloc& allocator)
+            {
+                using A = BlockAllocator<Alloc>;
+                auto alloc = A(allocator);
+                auto* frame = std::allocator_traits<A>::allocate(alloc, blocksFor<A>(size));
+                auto* bytes = reinterpret_cast<std::byte*>(frame);
+                ::new (bytes + releaseOffset(size)) Release(&release<A>);
+                ::new (bytes + allocatorOffset<A>(size)) A(std::move(alloc));
+                return frame;
+            }
+
+            static void deallocate(void* frame, std::size_t size) noexcept
+            {
+                auto* bytes = static_cast<std::byte*>(frame);
+                const auto release = *std::launder(reinterpret_cast<Release*>(bytes + releaseOffset(size)));
+                release(frame, size);
+            }
+        };
+    } //namespace Detail
+
+    //A lazy sequence of T computed by a coroutine, one element per resumption.
+    //The frame is allocated with the allocator following std::allocator_arg
+    //among the parameters of the coroutine, or with std::allocator otherwise.
+    //Coroutines taking an allocator build without warnings when defined between
+    //IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_BEGIN and IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_END.
+    template <typename T>
+    class Generator
+    {
+    public:
+        using value_type = std::remove_cvref_t<T>;
+        using reference = std::conditional_t<std::is_reference_v<T>, T, const T&>;
+
+        class promise_type
+        {
+        public:
+            Generator get_return_object() noexcept { return Generator{ Handle::from_promise(*this) }; }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            std::suspend_always yield_value(reference value) noexcept
+            {
+                current = std::addressof(value);
+                return {};
+            }
+
+            void return_void() const noexcept { }
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+
+            //a generator only yields, it cannot await
+            template <typename U>
+            void await_transform(U&&) = delete;
+
+            static void* operator new(std::size_t size)
+            {
+                return Detail::FrameAllocation::allocate(size, std::allocator<std::byte>{});
+            }
+
+            template <typename Alloc, typename... Args>
+            static void* operator new(std::size_t size, std::allocator_arg_t, const Alloc& alloc, const Args&...)
+            {
+                return Detail::FrameAllocation::allocate(size, alloc);
+            }
+
+            //for member functions and lambdas, which receive the object first
+            template <typename This, typename Alloc, typename... Args>
+            static void* operator new(std::size_t size, const This&, std::allocator_arg_t, const Alloc& alloc, const Args&...)
+            {
+                return Detail::FrameAllocation::allocate(size, alloc);
+            }
+
+            static void operator delete(void* frame, std::size_t size) noexcept
+            {
+                Detail::FrameAllocation::deallocate(frame, size);
+            }
+
+        private:
+            friend class Generator;
+
+            std::add_pointer_t<reference> current = nullptr;
+            std::exception_ptr error;
+        };
+
+    private:
+        using Handle = std::coroutine_handle<promise_type>;
+
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = Generator::value_type;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+
+            reference operator*() const noexcept { return static_cast<reference>(*coroutine.promise().current); }
+
+            Iterator& operator++()
+            {
+                Generator::advance(coroutine);
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const Iterator& it, std::default_sentinel_t) noexcept
+            {
+                return !it.coroutine || it.coroutine.done();
+            }
+
+        private:
+            friend class Generator;
+
+            explicit Iterator(Handle coroutine) noexcept : coroutine(coroutine) { }
+
+            Handle coroutine = nullptr;
+        };
+
+        Generator(Generator&& source) noexcept : coroutine(std::exchange(source.coroutine, nullptr)) { }
+
+        Generator& operator=(Generator&& rhs) noexcept
+        {
+            if (this != &rhs) {
+                destroy();
+                coroutine = std::exchange(rhs.coroutine, nullptr);
+            }
+            return *this;
+        }
+
+        ~Generator() { destroy(); }
+
+        //starts the coroutine, so it can be called once
+        Iterator begin()
+        {
+            advance(coroutine);
+            return Iterator{ coroutine };
+        }
+
+        std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+
+    private:
+        explicit Generator(Handle coroutine) noexcept : coroutine(coroutine) { }
+
+        static void advance(Handle coroutine)
+        {
+            coroutine.resume();
+            if (auto& promise = coroutine.promise(); promise.error) {
+                std::rethrow_exception(std::exchange(promise.error, nullptr));
+            }
+        }
+
+        void destroy() noexcept
+        {
+            if (coroutine) {
+                coroutine.destroy();
+            }
+        }
+
+        Handle coroutine;
+    };
+
+IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_BEGIN
+    namespace Detail
+    {
+        template <typename Stored, typename Alloc,
+                  typename Value = std::ranges::range_value_t<std::remove_reference_t<Stored>>
+        > Generator<Value> generateFrom(std::allocator_arg_t, Alloc, Stored range)
+        {
+            for (auto&& x : range) {
+                co_yield x;
+            }
+        }
+
+        //each element of source is pushed through the stages and the result, if any, is yielded
+        template <typename T, typename Alloc, typename... Stages,
+                  typename Out = typename Pipeline<Stages...>::template Output<typename Generator<T>::reference>
+        > Generator<Out> pipe(std::allocator_arg_t, Alloc, Generator<T> source, Pipeline<Stages...> pipeline)
+        {
+            auto slot = std::optional<Out>{};
+            auto sink = pipeline.makeSink([&slot](auto&& x)
+            {
+                slot.emplace(std::forward<decltype(x)>(x));
+                return true;
+            });
+
+            if (pipeline.acceptsNothing()) {
+                co_return;
+            }
+            for (auto it = source.begin(); it != source.end(); ++it) {
+                const auto more = sink(*it);
+                if (slot) {
+                    co_yield *slot;
+                    slot.reset();
+                }
+                if (!more) {
+                    break;
+                }
+            }
+        }
+    } //namespace Detail
+IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_END
+
+    //the elements of range, which is referred to when it is an lvalue and owned otherwise
+    template <typename Range, typename Alloc = std::allocator<std::byte>,
+              typename = std::enable_if_t<std::ranges::input_range<Range>>
+    > auto generate(Range&& range, const Alloc& alloc = {})
+    {
+        if constexpr (std::is_lvalue_reference_v<Range>) {
+            return Detail::generateFrom<Range>(std::allocator_arg, alloc, range);
+        }
+        else {
+            return Detail::generateFrom<std::remove_cvref_t<Range>>(std::allocator_arg, alloc, std::move(range));
+        }
+    }
+
+    //source | pipeline lazily yields the results of a non-folding pipeline
+    //and folds the whole of source with a folding one
+    template <typename T, typename... Stages, typename Alloc = std::allocator<std::byte>>
+    auto pipe(Generator<T> source, const Detail::Pipeline<Stages...>& pipeline, const Alloc& alloc = {})
+    {
+        if constexpr (Detail::Pipeline<Stages...>::isFolding) {
+            return pipeline(source);
+        }
+        else {
+            return Detail::pipe(std::allocator_arg, alloc, std::move(source), pipeline);
+        }
+    }
+
+    template <typename T, typename... Stages>
+    auto operator|(Generator<T> source, const Detail::Pipeline<Stages...>& pipeline)
+    {
+        return pipe(std::move(source), pipeline);
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "batch.hpp"
+#include <functional>
+#include <span>
+
+//Defining IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES declares the range kernels of the sections
+//(apply and mask of plus(k), lessThan(k), ...) over the common arithmetic types as instantiated elsewhere,
+//so that the translation units using them do not instantiate them again. src/instantiations.cpp
+//defines them and must be built with the same flags, IDRAGNEV_FUNCTIONAL_NO_SIMD included.
+
+#define IDRAGNEV_FUNCTIONAL_INTEGRAL_TYPES(X, OP) X(OP, int) X(OP, long) X(OP, unsigned)
+#define IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, OP) IDRAGNEV_FUNCTIONAL_INTEGRAL_TYPES(X, OP) X(OP, float) X(OP, double)
+
+//X(Op, T) for each operation of a section with a range kernel of its results
+#define IDRAGNEV_FUNCTIONAL_FOR_EACH_APPLY_KERNEL(X)             \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::plus<>)         \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::minus<>)        \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::multiplies<>)   \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::divides<>)      \
+    IDRAGNEV_FUNCTIONAL_INTEGRAL_TYPES(X, std::modulus<>)
+
+//X(Op, T) for each operation of a section with a range kernel of its mask
+#define IDRAGNEV_FUNCTIONAL_FOR_EACH_MASK_KERNEL(X)              \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::equal_to<>)     \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::not_equal_to<>) \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::less<>)         \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::greater<>)      \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::less_equal<>)   \
+    IDRAGNEV_FUNCTIONAL_ARITHMETIC_TYPES(X, std::greater_equal<>)
+
+#define IDRAGNEV_FUNCTIONAL_APPLY_KERNEL(OP, T)                                 \
+    template void IDragnev::Functional::Detail::applyRightSection<OP, T, T, T>( \
+        const OP&, const T&, std::span<const T>, std::span<T>);
+
+#define IDRAGNEV_FUNCTIONAL_MASK_KERNEL(OP, T)                                                       \
+    template IDragnev::Functional::Bitmask IDragnev::Functional::Detail::maskRightSection<OP, T, T>( \
+        const OP&, const T&, std::span<const T>);
+
+#ifdef IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES
+
+#define IDRAGNEV_FUNCTIONAL_EXTERN_APPLY_KERNEL(OP, T) extern IDRAGNEV_FUNCTIONAL_APPLY_KERNEL(OP, T)
+#define IDRAGNEV_FUNCTIONAL_EXTERN_MASK_KERNEL(OP, T) extern IDRAGNEV_FUNCTIONAL_MASK_KERNEL(OP, T)
+
+IDRAGNEV_FUNCTIONAL_FOR_EACH_APPLY_KERNEL(IDRAGNEV_FUNCTIONAL_EXTERN_APPLY_KERNEL)
+IDRAGNEV_FUNCTIONAL_FOR_EACH_MASK_KERNEL(IDRAGNEV_FUNCTIONAL_EXTERN_MASK_KERNEL)
+
+#undef IDRAGNEV_FUNCTIONAL_EXTERN_APPLY_KERNEL
+#undef IDRAGNEV_FUNCTIONAL_EXTERN_MASK_KERNEL
+
+#endif //IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES
\ No newline at end of file
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "functional.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Defining IDRAGNEV_FUNCTIONAL_DISABLE_INSTRUMENTATION turns instrument and instrumentStages
+//into functions returning their argument as it is and leaves instrumentationReport empty.
+
+namespace IDragnev::Functional
+{
+    inline constexpr std::size_t latencyBuckets = 40;
+
+    //latencies[0] counts the calls that took less than a nanosecond,
+    //latencies[i] the calls that took [2^(i-1), 2^i) nanoseconds, the last bucket counts the rest too
+    struct CallStats
+    {
+        std::string name;
+        std::uint64_t calls = 0;
+        std::uint64_t exceptions = 0;
+        std::chrono::nanoseconds total{ 0 };
+        std::array<std::uint64_t, latencyBuckets> latencies{};
+    };
+
+    namespace Detail
+    {
+        //Each thread records into one of a fixed number of shards, so threads contend only
+        //when there are more of them than shards. The shards are summed when the stats are read.
+        class Probe
+        {
+        private:
+            static constexpr std::size_t shardCount = 16;
+
+            struct alignas(64) Shard
+            {
+                std::atomic<std::uint64_t> calls = 0;
+                std::atomic<std::uint64_t> exceptions = 0;
+                std::atomic<std::uint64_t> nanoseconds = 0;
+                std::array<std::atomic<std::uint64_t>, latencyBuckets> latencies{};
+            };
+
+        public:
+            explicit Probe(std::string name) : name(std::move(name)) { }
+
+            void record(std::chrono::nanoseconds elapsed, bool failed) noexcept
+            {
+                auto& shard = shards[threadSlot()];
+                const auto ns = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(0, elapsed.count()));
+                const auto bucket = std::min<std::size_t>(std::bit_width(ns), latencyBuckets - 1);
+
+                shard.calls.fetch_add(1, std::memory_order_relaxed);
+                shard.nanoseconds.fetch_add(ns, std::memory_order_relaxed);
+                shard.latencies[bucket].fetch_add(1, std::memory_order_relaxed);
+                if (failed) {
+                    shard.exceptions.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            void addTo(CallStats& stats) const noexcept
+            {
+                for (const auto& shard : shards) {
+                    stats.calls += shard.calls.load(std::memory_order_relaxed);
+                    stats.exceptions += shard.exceptions.load(std::memory_order_relaxed);
+                    stats.total += std::chrono::nanoseconds(shard.nanoseconds.load(std::memory_order_relaxed));
+                    for (auto i = std::size_t{ 0 }; i < latencyBuckets; ++i) {
+                        stats.latencies[i] += shard.latencies[i].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            CallStats stats() const
+            {
+                auto result = CallStats{ name };
+                addTo(result);
+                return result;
+            }
+
+            const std::string name;
+
+        private:
+            static std::size_t threadSlot() noexcept
+            {
+                static std::atomic<std::size_t> threads = 0;
+                static thread_local const auto slot = threads.fetch_add(1, std::memory_order_relaxed) % shardCount;
+                return slot;
+            }
+
+            std::array<Shard, shardCount> shards;
+        };
+
+        //the probes of all instrumented functions which are still alive
+        class ProbeRegistry
+        {
+        public:
+            static ProbeRegistry& instance()
+            {
+                static auto registry = ProbeRegistry{};
+                return registry;
+            }
+
+            std::shared_ptr<Probe> make(std::string name)
+            {
+                auto probe = std::make_shared<Probe>(std::move(name));
+                auto lock = std::lock_guard{ guard };
+                std::erase_if(probes, [](const auto& p) { return p.expired(); });
+                probes.push_back(probe);
+                return probe;
+            }
+
+            std::vector<CallStats> report() const
+            {
+                auto result = std::vector<CallStats>{};
+                auto lock = std::lock_guard{ guard };
+                for (const auto& p : probes) {
+                    if (const auto probe = p.lock()) {
+                        const auto pos = std::find_if(std::begin(result), std::end(result), [&probe](const auto& stats) { return stats.name == probe->name; });
+                        if (pos != std::end(result)) {
+                            probe->addTo(*pos);
+                        }
+                        else {
+                            result.push_back(probe->stats());
+                        }
+                    }
+                }
+                return result;
+            }
+
+        private:
+            ProbeRegistry() = default;
+
+            mutable std::mutex guard;
+            std::vector<std::weak_ptr<Probe>> probes;
+        };
+
+        //records the call when it goes out of scope, whether the call returned or threw
+        class ProbeScope
+        {
+        public:
+            explicit ProbeScope(Probe& probe) noexcept
+                : probe(probe),
+                  exceptions(std::uncaught_exceptions()),
+                  start(std::chrono::steady_clock::now())
+            {
+            }
+
+            ProbeScope(const ProbeScope&) = delete;
+            ProbeScope& operator=(const ProbeScope&) = delete;
+
+            ~ProbeScope()
+            {
+                probe.record(std::chrono::steady_clock::now() - start, std::uncaught_exceptions() > exceptions);
+            }
+
+        private:
+            Probe& probe;
+            int exceptions;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        //Copies share their probe, so the stats of an instrumented function
+        //cover the calls made through any of its copies.
+        template <typename F>
+        class Instrumented
+        {
+        public:
+            Instrumented(std::string name, F f)
+                : f(std::move(f)),
+                  probe(ProbeRegistry::instance().make(std::move(name)))
+            {
+            }
+
+            template <typename... Args>
+            decltype(auto) operator()(Args&&... args) const
+                noexcept(std::is_nothrow_invocable_v<const F&, Args...>)
+            {
+                const auto scope = ProbeScope{ *probe };
+                return (invoke)(f, std::forward<Args>(args)...);
+            }
+
+            CallStats stats() const { return probe->stats(); }
+
+        private:
+            [[no_unique_address]] F f;
+            std::shared_ptr<Probe> probe;
+        };
+
+        template <typename... Fs, std::size_t... Is>
+        auto instrumentEach(const std::string& name, const Composed<Fs...>& f, std::index_sequence<Is...>)
+        {
+            return Composed<Instrumented<Fs>...>{ Instrumented<Fs>{ name + "/" + std::to_string(Is), std::get<Is>(f.functions()) }... };
+        }
+
+        template <bool lastUseMoves, typename F, typename... Gs, std::size_t... Is>
+        auto instrumentEach(const std::string& name, const Superposed<lastUseMoves, F, Gs...>& f, std::index_sequence<Is...>)
+        {
+            return Superposed<lastUseMoves, Instrumented<F>, Instrumented<Gs>...>{
+                Instrumented<F>{ name + "/0", f.function() },
+                Instrumented<Gs>{ name + "/" + std::to_string(Is + 1), std::get<Is>(f.functions()) }...
+            };
+        }
+    } //namespace Detail
+
+#ifndef IDRAGNEV_FUNCTIONAL_DISABLE_INSTRUMENTATION
+
+    //f, with the count, the latencies and the exceptions of its calls recorded under name
+    template <typename F>
+    auto instrument(std::string name, F f)
+    {
+        return Detail::Instrumented<F>{ std::move(name), std::move(f) };
+    }
+
+    //instruments a composition or a superposition under name and each of its functions under name/i,
+    //i being the position of the function in the call to compose or superpose
+    template <typename F>
+    auto instrumentStages(std::string name, F f)
+    {
+        if constexpr (Detail::IsComposed<F>::value || Detail::IsSuperposed<F>::value) {
+            auto stages = Detail::instrumentEach(name, f, std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(f.functions())>>>{});
+            return instrument(std::move(name), std::move(stages));
+        }
+        else {
+            return instrument(std::move(name), std::move(f));
+        }
+    }
+
+    //the stats of the functions instrumented so far which are still alive,
+    //those with the same name summed up
+    inline std::vector<CallStats> instrumentationReport()
+    {
+        return Detail::ProbeRegistry::instance().report();
+    }
+
+#else
+
+    template <typename F>
+    constexpr F instrument(const std::string&, F f) noexcept(std::is_nothrow_move_constructible_v<F>)
+    {
+        return f;
+    }
+
+    template <typename F>
+    constexpr F instrumentStages(const std::string&, F f) noexcept(std::is_nothrow_move_constructible_v<F>)
+    {
+        return f;
+    }
+
+    inline std::vector<CallStats> instrumentationReport()
+    {
+        return {};
+    }
+
+#endif //IDRAGNEV_FUNCTIONAL_DISABLE_INSTRUMENTATION
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -1,6 +1,7 @@
-﻿#pragma once
+#pragma once
 
 #include <type_traits>
+#include <utility>
 
 namespace IDragnev::Functional
 {
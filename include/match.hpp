@@ -0,0 +1,78 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "firstOf.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename T>
+        struct IsFirstOf : std::false_type { };
+
+        template <typename... Fs>
+        struct IsFirstOf<FirstOf<Fs...>> : std::true_type { };
+
+        template <typename Visitor, typename Alternative>
+        constexpr bool isHandled() noexcept
+        {
+            using V = std::remove_cvref_t<Visitor>;
+            if constexpr (IsFirstOf<V>::value) {
+                static_assert(!V::template isDeleted<Alternative>(),
+                              "An alternative of the variant is handled by a Deleted overload");
+            }
+            return std::is_invocable_v<Visitor, Alternative>;
+        }
+
+        template <typename Visitor, typename Variant, std::size_t... Is>
+        constexpr decltype(auto) matchByTable(Visitor&& visitor, Variant&& variant, std::index_sequence<Is...>)
+        {
+            static_assert((isHandled<Visitor, decltype(std::get<Is>(std::declval<Variant>()))>() && ...),
+                          "Every alternative of the variant must be handled by the visitor");
+
+            using R = std::invoke_result_t<Visitor, decltype(std::get<0>(std::declval<Variant>()))>;
+            static_assert((std::is_same_v<R, std::invoke_result_t<Visitor, decltype(std::get<Is>(std::declval<Variant>()))>> && ...),
+                          "The visitor must give the same result type for all alternatives");
+
+            //one entry per alternative, the overload of each is resolved at compile time
+            using Entry = R (*)(Visitor&&, Variant&&);
+            constexpr Entry table[] = {
+                [](Visitor&& visitor, Variant&& variant) -> R
+                {
+                    return (invoke)(std::forward<Visitor>(visitor), std::get<Is>(std::forward<Variant>(variant)));
+                }...
+            };
+
+            if (variant.valueless_by_exception()) {
+                throw std::bad_variant_access{};
+            }
+            return table[variant.index()](std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+        }
+    } //namespace Detail
+
+    //visitor(std::get<I>(variant)) for the active alternative I, dispatched through a table
+    //of functions, one per alternative. When visitor is a firstOf, an alternative reaching
+    //a Deleted entry is rejected at compile time.
+    template <typename Variant, typename Visitor>
+    constexpr decltype(auto) match(Variant&& variant, Visitor&& visitor)
+    {
+        constexpr auto size = std::variant_size_v<std::remove_cvref_t<Variant>>;
+        return Detail::matchByTable(std::forward<Visitor>(visitor), std::forward<Variant>(variant), std::make_index_sequence<size>{});
+    }
+
+    //as std::visit, but a single variant is matched through a table with no further instantiations
+    template <typename Visitor, typename... Variants>
+    constexpr decltype(auto) visitFirstOf(Visitor&& visitor, Variants&&... variants)
+    {
+        if constexpr (sizeof...(Variants) == 1) {
+            return match(std::forward<Variants>(variants)..., std::forward<Visitor>(visitor));
+        }
+        else {
+            return std::visit(std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+        }
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
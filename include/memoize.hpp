@@ -0,0 +1,334 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "callableTraits.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    struct CacheStats
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
+    namespace Detail
+    {
+        struct TupleHash
+        {
+            template <typename... Ts>
+            std::size_t operator()(const std::tuple<Ts...>& key) const noexcept
+            {
+                return std::apply([](const auto&... xs)
+                {
+                    auto seed = std::size_t{ 0 };
+                    ((seed ^= std::hash<std::decay_t<decltype(xs)>>{}(xs) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+                    return seed;
+                }, key);
+            }
+        };
+
+        //Each store maps the argument tuples to the results with
+        //  std::optional<Value> find(const Key&)
+        //  void insert(const Key&, const Value&)
+
+        template <typename Key, typename Value>
+        class UnboundedStore
+        {
+        public:
+            std::optional<Value> find(const Key& key) const
+            {
+                if (const auto it = values.find(key); it != values.end()) {
+                    return it->second;
+                }
+                return std::nullopt;
+            }
+
+            void insert(const Key& key, const Value& value) { values.emplace(key, value); }
+
+        private:
+            std::unordered_map<Key, Value, TupleHash> values;
+        };
+
+        //a hit makes the entry the most recently used one, an insertion into a full store
+        //evicts the least recently used one
+        template <typename Key, typename Value>
+        class LruStore
+        {
+        private:
+            using Entry = std::pair<Key, Value>;
+            using Iterator = typename std::list<Entry>::iterator;
+
+        public:
+            explicit LruStore(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)) { }
+
+            std::optional<Value> find(const Key& key)
+            {
+                const auto it = positions.find(key);
+                if (it == positions.end()) {
+                    return std::nullopt;
+                }
+                entries.splice(entries.begin(), entries, it->second);
+                return it->second->second;
+            }
+
+            void insert(const Key& key, const Value& value)
+            {
+                if (const auto it = positions.find(key); it != positions.end()) {
+                    return;
+                }
+                if (entries.size() == capacity) {
+                    positions.erase(entries.back().first);
+                    entries.pop_back();
+                }
+                entries.emplace_front(key, value);
+                positions.emplace(key, entries.begin());
+            }
+
+        private:
+            std::size_t capacity;
+            std::list<Entry> entries;
+            std::unordered_map<Key, Iterator, TupleHash> positions;
+        };
+
+        //slot key % size holds the last result computed for a key mapped to it
+        template <typename Key, typename Value>
+        class DirectMappedStore
+        {
+        private:
+            using Integral = std::tuple_element_t<0, Key>;
+
+            struct Slot
+            {
+                Integral key;
+                std::optional<Value> value;
+            };
+
+        public:
+            explicit DirectMappedStore(std::size_t size) : slots(std::max<std::size_t>(1, size)) { }
+
+            std::optional<Value> find(const Key& key) const
+            {
+                const auto& slot = slotFor(std::get<0>(key));
+                if (slot.value && slot.key == std::get<0>(key)) {
+                    return slot.value;
+                }
+                return std::nullopt;
+            }
+
+            void insert(const Key& key, const Value& value)
+            {
+                auto& slot = slotFor(std::get<0>(key));
+                slot.key = std::get<0>(key);
+                slot.value = value;
+            }
+
+        private:
+            Slot& slotFor(Integral key) { return slots[position(key) % slots.size()]; }
+            const Slot& slotFor(Integral key) const { return slots[position(key) % slots.size()]; }
+
+            //bool has no unsigned counterpart, false and true take slots 0 and 1
+            static std::size_t position(Integral key) noexcept
+            {
+                if constexpr (std::is_same_v<Integral, bool>) {
+                    return key ? 1 : 0;
+                }
+                else {
+                    return static_cast<std::make_unsigned_t<Integral>>(key);
+                }
+            }
+
+            std::vector<Slot> slots;
+        };
+
+        //the keys are spread between independently locked stores, so only calls
+        //falling into the same shard contend; f itself is called with no lock held
+        template <typename Key, typename Value, typename Inner>
+        class ShardedStore
+        {
+        private:
+            struct Shard
+            {
+                explicit Shard(Inner store) : store(std::move(store)) { }
+
+                std::mutex guard;
+                Inner store;
+            };
+
+        public:
+            template <typename Policy>
+            ShardedStore(std::size_t count, const Policy& inner)
+            {
+                count = std::max<std::size_t>(1, count);
+                shards.reserve(count);
+                for (auto i = std::size_t{ 0 }; i < count; ++i) {
+                    shards.push_back(std::make_unique<Shard>(inner.template makeStore<Key, Value>()));
+                }
+            }
+
+            std::optional<Value> find(const Key& key)
+            {
+                auto& shard = shardFor(key);
+                auto lock = std::lock_guard{ shard.guard };
+                return shard.store.find(key);
+            }
+
+            void insert(const Key& key, const Value& value)
+            {
+                auto& shard = shardFor(key);
+                auto lock = std::lock_guard{ shard.guard };
+                shard.store.insert(key, value);
+            }
+
+        private:
+            Shard& shardFor(const Key& key) { return *shards[TupleHash{}(key) % shards.size()]; }
+
+            std::vector<std::unique_ptr<Shard>> shards;
+        };
+
+        template <typename F, typename Store, typename... Args>
+        class Memoized
+        {
+        private:
+            using Key = std::tuple<Args...>;
+            using Value = std::decay_t<std::invoke_result_t<const F&, const Args&...>>;
+
+            struct State
+            {
+                explicit State(Store store) : store(std::move(store)) { }
+
+                Store store;
+                std::atomic<std::size_t> hits = 0;
+                std::atomic<std::size_t> misses = 0;
+            };
+
+        public:
+            Memoized(F f, Store store)
+                : f(std::move(f)),
+                  state(std::make_shared<State>(std::move(store)))
+            {
+            }
+
+            //the copies of a memoized function share its cache
+            Value operator()(const Args&... args) const
+            {
+                auto key = Key{ args... };
+                if (auto value = state->store.find(key)) {
+                    state->hits.fetch_add(1, std::memory_order_relaxed);
+                    return std::move(*value);
+                }
+                state->misses.fetch_add(1, std::memory_order_relaxed);
+                auto value = Value((invoke)(f, args...));
+                state->store.insert(key, value);
+                return value;
+            }
+
+            CacheStats stats() const noexcept
+            {
+                return { state->hits.load(std::memory_order_relaxed), state->misses.load(std::memory_order_relaxed) };
+            }
+
+        private:
+            [[no_unique_address]] F f;
+            std::shared_ptr<State> state;
+        };
+
+        template <typename Tuple>
+        struct DecayedTuple;
+
+        template <typename... Ts>
+        struct DecayedTuple<std::tuple<Ts...>>
+        {
+            using type = std::tuple<std::decay_t<Ts>...>;
+        };
+
+        template <typename F, typename Policy, typename... Args>
+        auto makeMemoized(F f, const Policy& policy, std::tuple<Args...>*)
+        {
+            static_assert(std::is_invocable_v<const F&, const Args&...>,
+                          "f must accept its arguments as const lvalues");
+            using Value = std::invoke_result_t<const F&, const Args&...>;
+            static_assert(!std::is_void_v<Value>, "Functions returning void have nothing to memoize");
+
+            using Key = std::tuple<Args...>;
+            using Store = decltype(policy.template makeStore<Key, std::decay_t<Value>>());
+            return Memoized<F, Store, Args...>{ std::move(f), policy.template makeStore<Key, std::decay_t<Value>>() };
+        }
+    } //namespace Detail
+
+    //The cache policies, none but ShardedCache may be used by several threads at once.
+
+    struct UnboundedCache
+    {
+        template <typename Key, typename Value>
+        auto makeStore() const { return Detail::UnboundedStore<Key, Value>{}; }
+    };
+
+    struct LruCache
+    {
+        template <typename Key, typename Value>
+        auto makeStore() const { return Detail::LruStore<Key, Value>{ capacity }; }
+
+        std::size_t capacity;
+    };
+
+    //for functions of a single integral argument
+    struct DirectMappedCache
+    {
+        template <typename Key, typename Value>
+        auto makeStore() const
+        {
+            static_assert(std::tuple_size_v<Key> == 1 && std::is_integral_v<std::tuple_element_t<0, Key>>,
+                          "A direct-mapped cache needs a single integral argument");
+            return Detail::DirectMappedStore<Key, Value>{ size };
+        }
+
+        std::size_t size;
+    };
+
+    template <typename Inner = UnboundedCache>
+    struct ShardedCache
+    {
+        template <typename Key, typename Value>
+        auto makeStore() const
+        {
+            using InnerStore = decltype(inner.template makeStore<Key, Value>());
+            return Detail::ShardedStore<Key, Value, InnerStore>{ shards, inner };
+        }
+
+        std::size_t shards = 16;
+        Inner inner = {};
+    };
+
+    template <typename Inner>
+    ShardedCache(std::size_t, Inner) -> ShardedCache<Inner>;
+
+    //f is called once per distinct tuple of decayed arguments and the result is cached according to policy.
+    //The argument types are deduced for callables with a single signature and can be given
+    //explicitly as memoize<Args...>(f) for the rest, such as generic lambdas.
+    template <typename... Args, typename F, typename Policy = UnboundedCache>
+    auto memoize(F f, const Policy& policy = {})
+    {
+        if constexpr (sizeof...(Args) > 0) {
+            return Detail::makeMemoized(std::move(f), policy, static_cast<std::tuple<std::decay_t<Args>...>*>(nullptr));
+        }
+        else {
+            static_assert(Detail::hasCallableTraits<F>,
+                          "The argument types of f cannot be deduced, give them as in memoize<Args...>(f)");
+            using Key = typename Detail::DecayedTuple<typename Detail::CallableTraits<F>::Arguments>::type;
+            return Detail::makeMemoized(std::move(f), policy, static_cast<Key*>(nullptr));
+        }
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,360 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__clang__)
+#define IDRAGNEV_FUNCTIONAL_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define IDRAGNEV_FUNCTIONAL_IVDEP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define IDRAGNEV_FUNCTIONAL_IVDEP __pragma(loop(ivdep))
+#else
+#define IDRAGNEV_FUNCTIONAL_IVDEP
+#endif
+
+namespace IDragnev::Functional
+{
+    namespace Parallel
+    {
+        struct SequencedPolicy { };
+
+        //workers == 0 stands for one worker per hardware thread
+        struct ParallelPolicy
+        {
+            std::size_t workers = 0;
+        };
+
+        //as ParallelPolicy, but the calls within a chunk may also be interleaved by vectorization
+        struct ParallelUnsequencedPolicy
+        {
+            std::size_t workers = 0;
+        };
+
+        inline constexpr auto seq = SequencedPolicy{};
+        inline constexpr auto par = ParallelPolicy{};
+        inline constexpr auto parUnseq = ParallelUnsequencedPolicy{};
+    } //namespace Parallel
+
+    namespace Detail
+    {
+        inline constexpr std::size_t cacheLineSize = 64;
+
+        //below this many bytes of elements per chunk, starting a thread costs more than it saves
+        inline constexpr std::size_t minChunkBytes = 16 * 1024;
+        inline constexpr std::size_t chunksPerWorker = 4;
+
+        template <typename Policy>
+        inline constexpr bool isExecutionPolicy = std::is_same_v<Policy, Parallel::SequencedPolicy> ||
+                                                  std::is_same_v<Policy, Parallel::ParallelPolicy> ||
+                                                  std::is_same_v<Policy, Parallel::ParallelUnsequencedPolicy>;
+
+        template <typename Policy>
+        inline constexpr bool isUnsequenced = std::is_same_v<Policy, Parallel::ParallelUnsequencedPolicy>;
+
+        //a function can be shared between threads when calling it cannot modify it:
+        //either it is called through a const reference or it has no state at all
+        template <typename F, typename... Args>
+        inline constexpr bool isShareable = std::is_invocable_v<const F&, Args...> ||
+                                            (std::is_empty_v<F> && std::is_invocable_v<F&, Args...>);
+
+        template <typename F>
+        struct SharedCall
+        {
+            template <typename... Args>
+            constexpr decltype(auto) operator()(Args&&... args) const
+            {
+                if constexpr (std::is_invocable_v<const F&, Args...>) {
+                    return (invoke)(f, std::forward<Args>(args)...);
+                }
+                else {
+                    //a stateless function, so a copy of it is as good as the original
+                    auto g = f;
+                    return (invoke)(g, std::forward<Args>(args)...);
+                }
+            }
+
+            const F& f;
+        };
+
+        //splits [0, size) into chunks whose boundaries fall on cache line boundaries
+        //of the elements starting at base, so no two chunks write to the same cache line
+        class Chunks
+        {
+        public:
+            Chunks(std::size_t size, std::size_t elementSize, const void* base, std::size_t workers) noexcept
+                : size(size)
+            {
+                const auto perLine = std::max<std::size_t>(1, cacheLineSize / elementSize);
+                const auto address = reinterpret_cast<std::uintptr_t>(base);
+                head = std::min(size, ((cacheLineSize - address % cacheLineSize) % cacheLineSize) / elementSize);
+
+                const auto minChunk = std::max<std::size_t>(1, minChunkBytes / elementSize);
+                const auto wanted = std::max(minChunk, (size + workers * chunksPerWorker - 1) / (workers * chunksPerWorker));
+                stride = (wanted + perLine - 1) / perLine * perLine;
+            }
+
+            std::size_t count() const noexcept
+            {
+                if (size == 0) {
+                    return 0;
+                }
+                return std::max<std::size_t>(1, (size - head + stride - 1) / stride);
+            }
+
+            std::size_t begin(std::size_t chunk) const noexcept
+            {
+                return chunk == 0 ? 0 : std::min(size, head + chunk * stride);
+            }
+
+            std::size_t end(std::size_t chunk) const noexcept
+            {
+                return chunk + 1 == count() ? size : begin(chunk + 1);
+            }
+
+        private:
+            std::size_t size;
+            std::size_t head;
+            std::size_t stride;
+        };
+
+        template <typename Policy>
+        std::size_t workersOf(const Policy& policy) noexcept
+        {
+            if constexpr (std::is_same_v<Policy, Parallel::SequencedPolicy>) {
+                return 1;
+            }
+            else {
+                return policy.workers != 0 ? policy.workers : std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+
+        //runs body(chunk) for every chunk, the calling thread takes part in the work;
+        //the first exception thrown by body is rethrown once all workers are done
+        template <typename Body>
+        void forkJoin(std::size_t chunks, std::size_t workers, const Body& body)
+        {
+            auto next = std::atomic<std::size_t>{ 0 };
+            auto failed = std::atomic<bool>{ false };
+            auto error = std::exception_ptr{};
+            auto errorGuard = std::mutex{};
+
+            const auto work = [&]
+            {
+                for (auto chunk = next++; chunk < chunks && !failed; chunk = next++) {
+                    try {
+                        body(chunk);
+                    }
+                    catch (...) {
+                        auto lock = std::lock_guard{ errorGuard };
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        failed = true;
+                    }
+                }
+            };
+
+            {
+                const auto threadCount = std::min(workers, chunks);
+                auto threads = std::vector<std::jthread>{};
+                threads.reserve(threadCount > 0 ? threadCount - 1 : 0);
+                for (auto i = std::size_t{ 1 }; i < threadCount; ++i) {
+                    threads.emplace_back(work);
+                }
+                work();
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        template <typename Policy, typename Body>
+        void forEachChunk(const Policy& policy, const Chunks& chunks, const Body& body)
+        {
+            if constexpr (std::is_same_v<Policy, Parallel::SequencedPolicy>) {
+                for (auto chunk = std::size_t{ 0 }; chunk < chunks.count(); ++chunk) {
+                    body(chunk);
+                }
+            }
+            else {
+                forkJoin(chunks.count(), workersOf(policy), body);
+            }
+        }
+
+        template <typename Policy, typename Body>
+        void forEachIndex(std::size_t first, std::size_t last, Body& body)
+        {
+            if constexpr (isUnsequenced<Policy>) {
+                IDRAGNEV_FUNCTIONAL_IVDEP
+                for (auto i = first; i < last; ++i) {
+                    body(i);
+                }
+            }
+            else {
+                for (auto i = first; i < last; ++i) {
+                    body(i);
+                }
+            }
+        }
+
+        template <typename Iterator>
+        const void* addressOf(const Iterator& it) noexcept
+        {
+            if constexpr (std::contiguous_iterator<Iterator>) {
+                return std::to_address(it);
+            }
+            else {
+                return nullptr;
+            }
+        }
+    } //namespace Detail
+
+    namespace Parallel
+    {
+        //out[i] = f(range[i]), with the chunks aligned to the cache lines of out
+        template <typename Policy, typename Range, typename OutputIterator, typename F,
+                  typename = std::enable_if_t<Detail::isExecutionPolicy<Policy>>
+        > OutputIterator transform(const Policy& policy, const Range& range, OutputIterator out, F f)
+        {
+            static_assert(std::ranges::random_access_range<const Range> && std::random_access_iterator<OutputIterator>,
+                          "Parallel algorithms need random access ranges");
+            static_assert(Detail::isShareable<F, std::ranges::range_reference_t<const Range>>,
+                          "The function must be stateless or const-invocable to be shared between threads");
+
+            const auto first = std::ranges::begin(range);
+            const auto size = static_cast<std::size_t>(std::ranges::size(range));
+            using Element = std::iter_value_t<OutputIterator>;
+            const auto chunks = Detail::Chunks(size, sizeof(Element), Detail::addressOf(out), Detail::workersOf(policy));
+            const auto call = Detail::SharedCall<F>{ f };
+
+            Detail::forEachChunk(policy, chunks, [&](std::size_t chunk)
+            {
+                auto body = [&](std::size_t i) { out[i] = call(first[i]); };
+                Detail::forEachIndex<Policy>(chunks.begin(chunk), chunks.end(chunk), body);
+            });
+            return out + size;
+        }
+
+        template <typename Range, typename OutputIterator, typename F,
+                  typename = std::enable_if_t<std::ranges::random_access_range<const Range>>
+        > OutputIterator transform(const Range& range, OutputIterator out, F f)
+        {
+            return Parallel::transform(par, range, out, std::move(f));
+        }
+
+        //the results of f on the elements of range, in order
+        template <typename Policy, typename Range, typename F,
+                  typename = std::enable_if_t<Detail::isExecutionPolicy<Policy>>
+        > auto transform(const Policy& policy, const Range& range, F f)
+        {
+            using Result = std::decay_t<std::invoke_result_t<const F&, std::ranges::range_reference_t<const Range>>>;
+            auto result = std::vector<Result>(std::ranges::size(range));
+            Parallel::transform(policy, range, result.begin(), std::move(f));
+            return result;
+        }
+
+        template <typename Range, typename F,
+                  typename = std::enable_if_t<std::ranges::random_access_range<const Range>>
+        > auto transform(const Range& range, F f)
+        {
+            return Parallel::transform(par, range, std::move(f));
+        }
+
+        //calls f on every element of range, which f may modify in place
+        template <typename Policy, typename Range, typename F,
+                  typename = std::enable_if_t<Detail::isExecutionPolicy<Policy>>
+        > void forEach(const Policy& policy, Range&& range, F f)
+        {
+            static_assert(std::ranges::random_access_range<Range>,
+                          "Parallel algorithms need random access ranges");
+            static_assert(Detail::isShareable<F, std::ranges::range_reference_t<Range>>,
+                          "The function must be stateless or const-invocable to be shared between threads");
+
+            const auto first = std::ranges::begin(range);
+            const auto size = static_cast<std::size_t>(std::ranges::size(range));
+            using Element = std::ranges::range_value_t<Range>;
+            const auto chunks = Detail::Chunks(size, sizeof(Element), Detail::addressOf(first), Detail::workersOf(policy));
+            const auto call = Detail::SharedCall<F>{ f };
+
+            Detail::forEachChunk(policy, chunks, [&](std::size_t chunk)
+            {
+                auto body = [&](std::size_t i) { call(first[i]); };
+                Detail::forEachIndex<Policy>(chunks.begin(chunk), chunks.end(chunk), body);
+            });
+        }
+
+        template <typename Range, typename F,
+                  typename = std::enable_if_t<std::ranges::random_access_range<Range>>
+        > void forEach(Range&& range, F f)
+        {
+            Parallel::forEach(par, std::forward<Range>(range), std::move(f));
+        }
+
+        //init op range[0] op ... op range[n-1] for an associative op, which need not be commutative:
+        //each chunk is reduced on its own and the partial results are combined in order
+        template <typename Policy, typename Range, typename T, typename Op = std::plus<>,
+                  typename = std::enable_if_t<Detail::isExecutionPolicy<Policy>>
+        > T reduce(const Policy& policy, const Range& range, T init, Op op = {})
+        {
+            using Reference = std::ranges::range_reference_t<const Range>;
+            static_assert(std::ranges::random_access_range<const Range>,
+                          "Parallel algorithms need random access ranges");
+            static_assert(std::is_constructible_v<T, Reference>,
+                          "The elements must be convertible to the type of the initial value");
+            static_assert(Detail::isShareable<Op, T, Reference> && Detail::isShareable<Op, T, T>,
+                          "The function must be stateless or const-invocable to be shared between threads");
+
+            const auto first = std::ranges::begin(range);
+            const auto size = static_cast<std::size_t>(std::ranges::size(range));
+            using Element = std::ranges::range_value_t<const Range>;
+            const auto chunks = Detail::Chunks(size, sizeof(Element), nullptr, Detail::workersOf(policy));
+            const auto call = Detail::SharedCall<Op>{ op };
+
+            //padded so that the workers do not write to the same cache line
+            struct alignas(Detail::cacheLineSize) Partial
+            {
+                std::optional<T> value;
+            };
+            auto partials = std::vector<Partial>(chunks.count());
+
+            Detail::forEachChunk(policy, chunks, [&](std::size_t chunk)
+            {
+                const auto last = chunks.end(chunk);
+                auto i = chunks.begin(chunk);
+                auto value = T(first[i]);
+                for (++i; i < last; ++i) {
+                    value = call(std::move(value), first[i]);
+                }
+                partials[chunk].value.emplace(std::move(value));
+            });
+
+            for (auto& partial : partials) {
+                init = call(std::move(init), std::move(*partial.value));
+            }
+            return init;
+        }
+
+        template <typename Range, typename T, typename Op = std::plus<>,
+                  typename = std::enable_if_t<std::ranges::random_access_range<const Range>>
+        > T reduce(const Range& range, T init, Op op = {})
+        {
+            return Parallel::reduce(par, range, std::move(init), std::move(op));
+        }
+    } //namespace Parallel
+} //namespace IDragnev::Functional
\ No newline at end of file
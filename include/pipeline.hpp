@@ -0,0 +1,314 @@
+#pragma once
+
+#include "functional.hpp"
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //Each stage wraps the sink of the next stage into a sink of its own.
+        //A sink takes one element and returns whether more elements are wanted,
+        //so a whole pipeline becomes a single loop body with no intermediate storage.
+
+        template <typename F>
+        struct MapStage
+        {
+            template <typename In>
+            using Output = std::invoke_result_t<const F&, In>;
+
+            template <typename Sink>
+            constexpr auto wrap(Sink next) const
+            {
+                return[this, next](auto&& x) mutable
+                {
+                    return next((invoke)(f, std::forward<decltype(x)>(x)));
+                };
+            }
+
+            [[no_unique_address]] F f;
+        };
+
+        template <typename P>
+        struct FilterStage
+        {
+            template <typename In>
+            using Output = In;
+
+            template <typename Sink>
+            constexpr auto wrap(Sink next) const
+            {
+                return[this, next](auto&& x) mutable
+                {
+                    return (invoke)(p, std::as_const(x)) ? next(std::forward<decltype(x)>(x)) : true;
+                };
+            }
+
+            [[no_unique_address]] P p;
+        };
+
+        struct TakeStage
+        {
+            template <typename In>
+            using Output = In;
+
+            template <typename Sink>
+            constexpr auto wrap(Sink next) const
+            {
+                return[left = n, next](auto&& x) mutable
+                {
+                    if (left == 0) {
+                        return false;
+                    }
+                    --left;
+                    return next(std::forward<decltype(x)>(x)) && left != 0;
+                };
+            }
+
+            std::size_t n;
+        };
+
+        //whether no element can get past the stage, so the source need not be pulled at all
+        template <typename Stage>
+        constexpr bool acceptsNothing(const Stage&) noexcept
+        {
+            return false;
+        }
+
+        constexpr bool acceptsNothing(const TakeStage& stage) noexcept
+        {
+            return stage.n == 0;
+        }
+
+        template <typename Op, typename T>
+        struct FoldStage
+        {
+            [[no_unique_address]] Op op;
+            T init;
+        };
+
+        template <typename T>
+        struct IsFoldStage : std::false_type { };
+
+        template <typename Op, typename T>
+        struct IsFoldStage<FoldStage<Op, T>> : std::true_type { };
+
+        //the type of the elements passed to the sink after the stages when the source yields In
+        template <typename In, typename... Stages>
+        struct StagesOutput
+        {
+            using type = In;
+        };
+
+        template <typename In, typename Stage, typename... Rest>
+        struct StagesOutput<In, Stage, Rest...>
+        {
+            using type = typename StagesOutput<typename Stage::template Output<In>, Rest...>::type;
+        };
+
+        //adjacent maps are fused with compose and adjacent filters with allOf
+        template <typename F, typename G>
+        constexpr auto fuse(const MapStage<F>& lhs, const MapStage<G>& rhs)
+        {
+            using Fused = decltype(compose(rhs.f, lhs.f));
+            return std::tuple{ MapStage<Fused>{ compose(rhs.f, lhs.f) } };
+        }
+
+        template <typename P, typename Q>
+        constexpr auto fuse(const FilterStage<P>& lhs, const FilterStage<Q>& rhs)
+        {
+            using Fused = decltype(allOf(lhs.p, rhs.p));
+            return std::tuple{ FilterStage<Fused>{ allOf(lhs.p, rhs.p) } };
+        }
+
+        template <typename S, typename T>
+        constexpr auto fuse(const S& lhs, const T& rhs)
+        {
+            return std::tuple{ lhs, rhs };
+        }
+
+        template <typename... Stages>
+        class Pipeline;
+
+        template <typename... Stages>
+        constexpr auto makePipeline(std::tuple<Stages...> stages)
+        {
+            return std::make_from_tuple<Pipeline<Stages...>>(std::move(stages));
+        }
+
+        template <typename... Stages>
+        class Pipeline
+        {
+        private:
+            static constexpr auto size = sizeof...(Stages);
+            using Last = std::tuple_element_t<size - 1, std::tuple<Stages...>>;
+
+            template <typename... Ts>
+            friend class Pipeline;
+
+        public:
+            static constexpr bool isFolding = IsFoldStage<Last>::value;
+
+            //the type of the results of a non-folding pipeline applied to elements of type In
+            template <typename In>
+            using Output = std::decay_t<typename StagesOutput<In, Stages...>::type>;
+
+            constexpr Pipeline(Stages... stages) : stages(std::move(stages)...) { }
+
+            //stages[0] | ... | stages[N-1] | other, with the boundary stages fused when possible
+            template <typename... Others>
+            constexpr auto operator|(const Pipeline<Others...>& other) const
+            {
+                static_assert(!isFolding, "fold must be the last stage of a pipeline");
+                return std::apply([this](const auto&... others)
+                {
+                    return append(others...);
+                }, other.stages);
+            }
+
+            //returns the folded value when the last stage is a fold
+            template <typename Iterator, typename Sentinel,
+                      typename = std::enable_if_t<std::input_iterator<Iterator>>
+            > constexpr auto operator()(Iterator first, Sentinel last) const
+            {
+                static_assert(isFolding, "a pipeline without a fold needs an output iterator");
+                auto result = std::get<size - 1>(stages).init;
+                const auto& op = std::get<size - 1>(stages).op;
+                run(first, last, [&result, &op](auto&& x)
+                {
+                    result = (invoke)(op, std::move(result), std::forward<decltype(x)>(x));
+                    return true;
+                });
+                return result;
+            }
+
+            //writes the results to out and returns the end of the written sequence
+            template <typename Iterator, typename Sentinel, typename OutputIterator,
+                      typename = std::enable_if_t<std::input_iterator<Iterator>>
+            > constexpr OutputIterator operator()(Iterator first, Sentinel last, OutputIterator out) const
+            {
+                static_assert(!isFolding, "a folding pipeline produces a single value");
+                run(first, last, [&out](auto&& x)
+                {
+                    *out = std::forward<decltype(x)>(x);
+                    ++out;
+                    return true;
+                });
+                return out;
+            }
+
+            template <typename Range,
+                      typename = std::enable_if_t<std::ranges::range<Range>>
+            > constexpr auto operator()(Range&& range) const
+            {
+                //beginning some ranges, such as generators, already pulls their first element
+                if constexpr (isFolding) {
+                    if (acceptsNothing()) {
+                        return std::get<size - 1>(stages).init;
+                    }
+                }
+                return (*this)(std::ranges::begin(range), std::ranges::end(range));
+            }
+
+            template <typename Range, typename OutputIterator,
+                      typename = std::enable_if_t<std::ranges::range<Range>>
+            > constexpr OutputIterator operator()(Range&& range, OutputIterator out) const
+            {
+                if (acceptsNothing()) {
+                    return out;
+                }
+                return (*this)(std::ranges::begin(range), std::ranges::end(range), out);
+            }
+
+            //the sink equivalent to the non-folding stages followed by terminal
+            template <typename Sink>
+            constexpr auto makeSink(Sink terminal) const
+            {
+                return wrap<0>(std::move(terminal));
+            }
+
+            //whether the stages let no element through, e.g. because of a take(0)
+            constexpr bool acceptsNothing() const noexcept
+            {
+                return std::apply([](const auto&... stages)
+                {
+                    return (Detail::acceptsNothing(stages) || ...);
+                }, stages);
+            }
+
+        private:
+            template <std::size_t I, typename Sink>
+            constexpr auto wrap(Sink terminal) const
+            {
+                if constexpr (I == size || (I == size - 1 && isFolding)) {
+                    return terminal;
+                }
+                else {
+                    return std::get<I>(stages).wrap(wrap<I + 1>(std::move(terminal)));
+                }
+            }
+
+            template <typename Iterator, typename Sentinel, typename Sink>
+            constexpr void run(Iterator first, Sentinel last, Sink terminal) const
+            {
+                if (acceptsNothing()) {
+                    return;
+                }
+                auto sink = makeSink(std::move(terminal));
+                for (; first != last; ++first) {
+                    if (!sink(*first)) {
+                        break;
+                    }
+                }
+            }
+
+            template <typename Next, typename... Others>
+            constexpr auto append(const Next& next, const Others&... others) const
+            {
+                auto init = std::apply([](const auto&... stages)
+                {
+                    return dropLast(stages...);
+                }, stages);
+                auto joint = std::tuple_cat(std::move(init), fuse(std::get<size - 1>(stages), next));
+                return makePipeline(std::tuple_cat(std::move(joint), std::tuple<Others...>{ others... }));
+            }
+
+            template <typename... Ts>
+            static constexpr auto dropLast(const Ts&... ts)
+            {
+                auto all = std::tuple<const Ts&...>{ ts... };
+                return [&all]<std::size_t... Is>(std::index_sequence<Is...>)
+                {
+                    return std::tuple<std::tuple_element_t<Is, std::tuple<Ts...>>...>{ std::get<Is>(all)... };
+                }(std::make_index_sequence<sizeof...(Ts) - 1>{});
+            }
+
+            std::tuple<Stages...> stages;
+        };
+    } //namespace Detail
+
+    inline constexpr auto map = [](auto f)
+    {
+        return Detail::Pipeline<Detail::MapStage<decltype(f)>>{ { std::move(f) } };
+    };
+
+    inline constexpr auto filter = [](auto predicate)
+    {
+        return Detail::Pipeline<Detail::FilterStage<decltype(predicate)>>{ { std::move(predicate) } };
+    };
+
+    inline constexpr auto take = [](std::size_t n)
+    {
+        return Detail::Pipeline<Detail::TakeStage>{ { n } };
+    };
+
+    inline constexpr auto fold = [](auto op, auto init)
+    {
+        return Detail::Pipeline<Detail::FoldStage<decltype(op), decltype(init)>>{ { std::move(op), std::move(init) } };
+    };
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "functional.hpp"
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //Expressions evaluate their subexpressions with the same arguments, as lvalues,
+        //so that a placeholder can be used more than once.
+        template <typename Derived>
+        struct Expression
+        {
+            //out[i] = e(in[i]) for contiguous ranges, vectorized when e works lane-wise on arithmetic types
+            template <typename In, typename Out>
+            void apply(const In& in, Out&& out) const
+            {
+                BatchKernels<In>::applyExpression(self(), in, out);
+            }
+
+            //bit i of the result is set when e(in[i]) holds, vectorized when e works lane-wise on arithmetic types
+            template <typename In>
+            auto mask(const In& in) const
+            {
+                return BatchKernels<In>::maskExpression(self(), in);
+            }
+
+        private:
+            constexpr const Derived& self() const noexcept { return static_cast<const Derived&>(*this); }
+        };
+
+        template <std::size_t I>
+        struct Placeholder : Expression<Placeholder<I>>
+        {
+            template <typename... Args,
+                      typename = std::enable_if_t<(I < sizeof...(Args))>
+            > constexpr decltype(auto) operator()(Args&&... args) const noexcept
+            {
+                return std::get<I>(std::forward_as_tuple(args...));
+            }
+        };
+
+        template <typename T>
+        struct Constant : Expression<Constant<T>>
+        {
+            constexpr Constant(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
+                : value(std::move(value))
+            {
+            }
+
+            template <typename... Args>
+            constexpr const T& operator()(const Args&...) const noexcept
+            {
+                return value;
+            }
+
+            T value;
+        };
+
+        template <typename Op, typename E>
+        struct UnaryExpression : Expression<UnaryExpression<Op, E>>
+        {
+            constexpr UnaryExpression(E e) noexcept(std::is_nothrow_move_constructible_v<E>)
+                : e(std::move(e))
+            {
+            }
+
+            template <typename... Args>
+            constexpr auto operator()(Args&&... args) const
+                noexcept(noexcept((invoke)(std::declval<const Op&>(), std::declval<const E&>()(args...))))
+                -> decltype((invoke)(std::declval<const Op&>(), std::declval<const E&>()(args...)))
+            {
+                return (invoke)(op, e(args...));
+            }
+
+            [[no_unique_address]] Op op;
+            [[no_unique_address]] E e;
+        };
+
+        template <typename Op, typename L, typename R>
+        struct BinaryExpression : Expression<BinaryExpression<Op, L, R>>
+        {
+            constexpr BinaryExpression(L l, R r) noexcept(std::is_nothrow_move_constructible_v<L> &&
+                                                          std::is_nothrow_move_constructible_v<R>)
+                : l(std::move(l)),
+                  r(std::move(r))
+            {
+            }
+
+            template <typename... Args>
+            constexpr auto operator()(Args&&... args) const
+                noexcept(noexcept((invoke)(std::declval<const Op&>(), std::declval<const L&>()(args...), std::declval<const R&>()(args...))))
+                -> decltype((invoke)(std::declval<const Op&>(), std::declval<const L&>()(args...), std::declval<const R&>()(args...)))
+            {
+                return (invoke)(op, l(args...), r(args...));
+            }
+
+            [[no_unique_address]] Op op;
+            [[no_unique_address]] L l;
+            [[no_unique_address]] R r;
+        };
+
+        template <std::size_t I>
+        struct IsExpression<Placeholder<I>> : std::true_type { };
+
+        template <typename T>
+        struct IsExpression<Constant<T>> : std::true_type { };
+
+        template <typename Op, typename E>
+        struct IsExpression<UnaryExpression<Op, E>> : std::true_type { };
+
+        template <typename Op, typename L, typename R>
+        struct IsExpression<BinaryExpression<Op, L, R>> : std::true_type { };
+
+        template <typename T>
+        inline constexpr bool isExpression = IsExpression<std::remove_cvref_t<T>>::value;
+
+        template <typename T>
+        constexpr auto asExpression(T&& x)
+        {
+            if constexpr (isExpression<T>) {
+                return std::forward<T>(x);
+            }
+            else {
+                return Constant<std::decay_t<T>>{ std::forward<T>(x) };
+            }
+        }
+
+        template <typename Op, typename L, typename R>
+        constexpr auto makeBinary(L&& l, R&& r)
+        {
+            using LE = decltype(asExpression(std::forward<L>(l)));
+            using RE = decltype(asExpression(std::forward<R>(r)));
+            return BinaryExpression<Op, LE, RE>{ asExpression(std::forward<L>(l)), asExpression(std::forward<R>(r)) };
+        }
+
+        template <typename L, typename R>
+        inline constexpr bool areOperands = isExpression<L> || isExpression<R>;
+
+        //found by argument dependent lookup, at least one operand being an expression
+#define IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(OP, FUNCTION)                         \
+        template <typename L, typename R,                                         \
+                  typename = std::enable_if_t<areOperands<L, R>>                  \
+        > constexpr auto operator OP(L&& l, R&& r)                                \
+        {                                                                         \
+            return makeBinary<FUNCTION>(std::forward<L>(l), std::forward<R>(r));  \
+        }
+
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(+, std::plus<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(-, std::minus<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(*, std::multiplies<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(/, std::divides<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(%, std::modulus<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(==, std::equal_to<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(!=, std::not_equal_to<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(<, std::less<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(>, std::greater<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(<=, std::less_equal<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(>=, std::greater_equal<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(&&, std::logical_and<>)
+        IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR(||, std::logical_or<>)
+
+#undef IDRAGNEV_FUNCTIONAL_BINARY_OPERATOR
+
+        template <typename E,
+                  typename = std::enable_if_t<isExpression<E>>
+        > constexpr auto operator-(E&& e)
+        {
+            return UnaryExpression<std::negate<>, std::remove_cvref_t<E>>{ std::forward<E>(e) };
+        }
+
+        template <typename E,
+                  typename = std::enable_if_t<isExpression<E>>
+        > constexpr auto operator!(E&& e)
+        {
+            return UnaryExpression<std::logical_not<>, std::remove_cvref_t<E>>{ std::forward<E>(e) };
+        }
+    } //namespace Detail
+
+    //_1 * 5 + _2 is a function of at least two arguments computing x * 5 + y.
+    //&& and || evaluate both of their operands.
+    namespace Placeholders
+    {
+        inline constexpr auto _1 = Detail::Placeholder<0>{};
+        inline constexpr auto _2 = Detail::Placeholder<1>{};
+        inline constexpr auto _3 = Detail::Placeholder<2>{};
+        inline constexpr auto _4 = Detail::Placeholder<3>{};
+    } //namespace Placeholders
+} //namespace IDragnev::Functional
\ No newline at end of file
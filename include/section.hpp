@@ -0,0 +1,70 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        //the range kernels behind the apply and mask members, defined in batch.hpp
+        template <typename In>
+        struct BatchKernels;
+
+        template <typename Op, typename T>
+        class RightSection
+        {
+        public:
+            template <typename U>
+            constexpr RightSection(std::in_place_t, U&& rhs) noexcept(std::is_nothrow_constructible_v<T, U>)
+                : rhs(std::forward<U>(rhs))
+            {
+            }
+
+            template <typename Lhs>
+            constexpr std::invoke_result_t<const Op&, Lhs, const T&>
+            operator()(Lhs&& lhs) const & noexcept(std::is_nothrow_invocable_v<const Op&, Lhs, const T&>)
+            {
+                return (invoke)(op, std::forward<Lhs>(lhs), rhs);
+            }
+
+            template <typename Lhs>
+            constexpr std::invoke_result_t<const Op&, Lhs, T>
+            operator()(Lhs&& lhs) && noexcept(std::is_nothrow_invocable_v<const Op&, Lhs, T>)
+            {
+                return (invoke)(op, std::forward<Lhs>(lhs), std::move(rhs));
+            }
+
+            constexpr const T& operand() const noexcept { return rhs; }
+
+            //out[i] = in[i] op rhs for contiguous ranges, vectorized for arithmetic types
+            template <typename In, typename Out>
+            void apply(const In& in, Out&& out) const
+            {
+                BatchKernels<In>::applySection(op, rhs, in, out);
+            }
+
+            //bit i of the result is set when in[i] op rhs holds, vectorized for arithmetic types
+            template <typename In>
+            auto mask(const In& in) const
+            {
+                return BatchKernels<In>::maskSection(op, rhs, in);
+            }
+
+        private:
+            [[no_unique_address]] Op op;
+            T rhs;
+        };
+
+        template <typename Op>
+        struct RightSectionBinder
+        {
+            template <typename T>
+            constexpr auto operator()(T&& rhs) const noexcept(std::is_nothrow_constructible_v<std::decay_t<T>, T>)
+            {
+                return RightSection<Op, std::decay_t<T>>{ std::in_place, std::forward<T>(rhs) };
+            }
+        };
+    } //namespace Detail
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "functional.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename Op, typename T>
+        inline constexpr bool isFoldable = (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::multiplies<>>) &&
+                                           std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                           std::is_same_v<decltype(std::declval<T>() + std::declval<T>()), T>;
+
+        //consecutive sections of an associative operation over the same integral type,
+        //operands[0] being applied first. A T argument takes a single operation with the folded operand,
+        //computed modulo 2^n so that it equals the chain whenever the chain does not overflow.
+        //Arguments of any other type go through the whole chain.
+        template <typename Op, typename T, std::size_t N>
+        class FoldedSection
+        {
+        private:
+            using Unsigned = std::make_unsigned_t<T>;
+
+        public:
+            constexpr FoldedSection(const std::array<T, N>& operands) noexcept
+                : operands(operands),
+                  folded(fold(operands))
+            {
+            }
+
+            template <typename Lhs>
+            constexpr decltype(auto) operator()(Lhs&& lhs) const
+                noexcept(std::is_same_v<std::remove_cvref_t<Lhs>, T> || isNothrowChain<0, Lhs>())
+            {
+                if constexpr (std::is_same_v<std::remove_cvref_t<Lhs>, T>) {
+                    return static_cast<T>(Op{}(static_cast<Unsigned>(lhs), folded));
+                }
+                else {
+                    return chain<0>(std::forward<Lhs>(lhs));
+                }
+            }
+
+            constexpr const std::array<T, N>& operandsInOrder() const noexcept { return operands; }
+
+        private:
+            static constexpr Unsigned fold(const std::array<T, N>& operands) noexcept
+            {
+                auto result = static_cast<Unsigned>(operands[0]);
+                for (auto i = std::size_t{ 1 }; i < N; ++i) {
+                    result = static_cast<Unsigned>(Op{}(result, static_cast<Unsigned>(operands[i])));
+                }
+                return result;
+            }
+
+            template <std::size_t I, typename Lhs>
+            static constexpr bool isNothrowChain() noexcept
+            {
+                if constexpr (!std::is_nothrow_invocable_v<const Op&, Lhs, const T&>) {
+                    return false;
+                }
+                else if constexpr (I + 1 == N) {
+                    return true;
+                }
+                else {
+                    return isNothrowChain<I + 1, std::invoke_result_t<const Op&, Lhs, const T&>>();
+                }
+            }
+
+            template <std::size_t I, typename Lhs>
+            constexpr decltype(auto) chain(Lhs&& lhs) const noexcept(isNothrowChain<I, Lhs>())
+            {
+                if constexpr (I + 1 == N) {
+                    return Op{}(std::forward<Lhs>(lhs), operands[I]);
+                }
+                else {
+                    return chain<I + 1>(Op{}(std::forward<Lhs>(lhs), operands[I]));
+                }
+            }
+
+            std::array<T, N> operands;
+            Unsigned folded;
+        };
+
+        template <typename F>
+        inline constexpr bool isIdentity = std::is_same_v<F, std::remove_const_t<decltype(identity)>>;
+
+        //the operands of a section of Op over T in the order they are applied
+        template <typename Op, typename T, typename F>
+        constexpr auto foldedOperands(const F& f) noexcept
+        {
+            if constexpr (std::is_same_v<F, RightSection<Op, T>>) {
+                return std::array<T, 1>{ f.operand() };
+            }
+            else {
+                return f.operandsInOrder();
+            }
+        }
+
+        template <typename A, typename B, std::size_t N, std::size_t M>
+        constexpr std::array<A, N + M> join(const std::array<A, N>& first, const std::array<B, M>& second) noexcept
+        {
+            auto result = std::array<A, N + M>{};
+            for (auto i = std::size_t{ 0 }; i < N; ++i) {
+                result[i] = first[i];
+            }
+            for (auto i = std::size_t{ 0 }; i < M; ++i) {
+                result[N + i] = second[i];
+            }
+            return result;
+        }
+
+        template <typename F>
+        struct SectionTraits
+        {
+            static constexpr bool isSection = false;
+        };
+
+        template <typename Op, typename T>
+        struct SectionTraits<RightSection<Op, T>>
+        {
+            static constexpr bool isSection = isFoldable<Op, T>;
+            using Operation = Op;
+            using Operand = T;
+        };
+
+        template <typename Op, typename T, std::size_t N>
+        struct SectionTraits<FoldedSection<Op, T, N>>
+        {
+            static constexpr bool isSection = true;
+            using Operation = Op;
+            using Operand = T;
+        };
+
+        template <typename Outer, typename Inner>
+        constexpr bool areFusible() noexcept
+        {
+            using O = SectionTraits<Outer>;
+            using I = SectionTraits<Inner>;
+            if constexpr (O::isSection && I::isSection) {
+                return std::is_same_v<typename O::Operation, typename I::Operation> &&
+                       std::is_same_v<typename O::Operand, typename I::Operand>;
+            }
+            else {
+                return false;
+            }
+        }
+
+        template <typename F>
+        constexpr auto simplifyOne(const F& f);
+
+        template <typename Tuple, typename... Gs>
+        constexpr auto pushAll(Tuple stages, const Gs&... funs);
+
+        template <typename Tuple, typename G, typename... Gs>
+        constexpr auto pushFirst(Tuple stages, const G& g, const Gs&... rest);
+
+        template <typename... Stages, std::size_t... Is>
+        constexpr auto dropLast([[maybe_unused]] std::tuple<Stages...> stages, std::index_sequence<Is...>)
+        {
+            return std::tuple{ std::get<Is>(std::move(stages))... };
+        }
+
+        //appends g to the stages of a composition, the outermost stage first,
+        //merging it into the last stage when the two can be fused
+        template <typename... Stages, typename G>
+        constexpr auto push(std::tuple<Stages...> stages, G g)
+        {
+            if constexpr (isIdentity<G>) {
+                return stages;
+            }
+            else if constexpr (IsComposed<G>::value) {
+                return std::apply([&stages](const auto&... funs)
+                {
+                    return pushAll(std::move(stages), funs...);
+                }, g.functions());
+            }
+            else if constexpr (sizeof...(Stages) > 0) {
+                using Last = std::tuple_element_t<sizeof...(Stages) - 1, std::tuple<Stages...>>;
+                if constexpr (areFusible<Last, G>()) {
+                    using Traits = SectionTraits<G>;
+                    using Operation = typename Traits::Operation;
+                    using Operand = typename Traits::Operand;
+
+                    const auto& last = std::get<sizeof...(Stages) - 1>(stages);
+                    const auto operands = join(foldedOperands<Operation, Operand>(g), foldedOperands<Operation, Operand>(last));
+                    auto fused = FoldedSection<Operation, Operand, std::tuple_size_v<decltype(operands)>>{ operands };
+                    return std::tuple_cat(dropLast(std::move(stages), std::make_index_sequence<sizeof...(Stages) - 1>{}), std::tuple{ fused });
+                }
+                else {
+                    return std::tuple_cat(std::move(stages), std::tuple{ std::move(g) });
+                }
+            }
+            else {
+                return std::tuple{ std::move(g) };
+            }
+        }
+
+        template <typename Tuple, typename... Gs>
+        constexpr auto pushAll(Tuple stages, const Gs&... funs)
+        {
+            if constexpr (sizeof...(Gs) == 0) {
+                return stages;
+            }
+            else {
+                return pushFirst(std::move(stages), funs...);
+            }
+        }
+
+        template <typename Tuple, typename G, typename... Gs>
+        constexpr auto pushFirst(Tuple stages, const G& g, const Gs&... rest)
+        {
+            return pushAll(push(std::move(stages), simplifyOne(g)), rest...);
+        }
+
+        template <typename... Stages>
+        constexpr auto toFunction(std::tuple<Stages...> stages)
+        {
+            if constexpr (sizeof...(Stages) == 0) {
+                return identity;
+            }
+            else if constexpr (sizeof...(Stages) == 1) {
+                return std::get<0>(std::move(stages));
+            }
+            else {
+                return std::make_from_tuple<Composed<Stages...>>(std::move(stages));
+            }
+        }
+
+        template <typename F>
+        struct IsInverse : std::false_type { };
+
+        template <typename P>
+        struct IsInverse<Inverse<P>> : std::true_type { };
+
+        template <typename F>
+        struct IsFlipped : std::false_type { };
+
+        template <typename F>
+        struct IsFlipped<Flipped<F>> : std::true_type { };
+
+        template <typename F>
+        constexpr auto simplifyOne(const F& f)
+        {
+            if constexpr (IsComposed<F>::value) {
+                return toFunction(std::apply([](const auto&... funs)
+                {
+                    return pushAll(std::tuple<>{}, funs...);
+                }, f.functions()));
+            }
+            else if constexpr (IsInverse<F>::value) {
+                using P = std::remove_cvref_t<decltype(f.predicate())>;
+                if constexpr (IsInverse<P>::value) {
+                    return simplifyOne(f.predicate().predicate());
+                }
+                else {
+                    return Inverse{ simplifyOne(f.predicate()) };
+                }
+            }
+            else if constexpr (IsFlipped<F>::value) {
+                using G = std::remove_cvref_t<decltype(f.function())>;
+                if constexpr (IsFlipped<G>::value) {
+                    return simplifyOne(f.function().function());
+                }
+                else {
+                    return Flipped{ simplifyOne(f.function()) };
+                }
+            }
+            else {
+                return f;
+            }
+        }
+    } //namespace Detail
+
+    //An equivalent of f with fewer calls, rewritten at compile time:
+    //identities are dropped from compositions and nested compositions are flattened,
+    //inverse(inverse(p)) becomes p, flip(flip(f)) becomes f, and consecutive sections of plus or times
+    //with operands of the same integral type are fused into one. Note that p is no longer
+    //converted to bool once its double inverse is dropped.
+    template <typename F>
+    constexpr auto simplify(const F& f)
+    {
+        return Detail::simplifyOne(f);
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
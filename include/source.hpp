@@ -0,0 +1,207 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "generator.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace IDragnev::Functional
+{
+    //the bytes of the mapped region between the advice windows
+    inline constexpr std::size_t defaultReadahead = std::size_t{ 4 } << 20;
+
+    namespace Detail
+    {
+        [[noreturn]] inline void throwSystemError(const char* what)
+        {
+            throw std::system_error{ errno, std::generic_category(), what };
+        }
+
+        //A read-only private mapping of a whole file
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string& path)
+            {
+                const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throwSystemError("open");
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0) {
+                    const auto error = errno;
+                    ::close(fd);
+                    errno = error;
+                    throwSystemError("fstat");
+                }
+                const auto length = static_cast<std::size_t>(info.st_size);
+                if (length == 0) {
+                    ::close(fd);
+                    return;
+                }
+                data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                const auto error = errno;
+                ::close(fd);
+                if (data == MAP_FAILED) {
+                    errno = error;
+                    throwSystemError("mmap");
+                }
+                size = length;
+                ::madvise(data, size, MADV_SEQUENTIAL);
+            }
+
+            MappedFile(MappedFile&& source) noexcept
+                : data(std::exchange(source.data, MAP_FAILED)),
+                  size(std::exchange(source.size, 0))
+            {
+            }
+
+            MappedFile& operator=(MappedFile&& rhs) noexcept
+            {
+                if (this != &rhs) {
+                    unmap();
+                    data = std::exchange(rhs.data, MAP_FAILED);
+                    size = std::exchange(rhs.size, 0);
+                }
+                return *this;
+            }
+
+            ~MappedFile() { unmap(); }
+
+            std::string_view contents() const noexcept
+            {
+                return size > 0 ? std::string_view{ static_cast<const char*>(data), size } : std::string_view{};
+            }
+
+            //asks the kernel to start reading [first, first + n) in the background
+            void prefetch(std::size_t first, std::size_t n) const noexcept
+            {
+                advise(first, n, MADV_WILLNEED);
+            }
+
+            //lets the kernel drop the pages of [first, first + n), which are read again if touched
+            void release(std::size_t first, std::size_t n) const noexcept
+            {
+                advise(first, n, MADV_DONTNEED);
+            }
+
+        private:
+            void advise(std::size_t first, std::size_t n, int advice) const noexcept
+            {
+                static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                const auto begin = first / page * page;
+                const auto end = std::min(first + n, size);
+                if (size > 0 && begin < end) {
+                    ::madvise(static_cast<char*>(data) + begin, end - begin, advice);
+                }
+            }
+
+            void unmap() noexcept
+            {
+                if (size > 0) {
+                    ::munmap(data, size);
+                }
+            }
+
+            void* data = MAP_FAILED;
+            std::size_t size = 0;
+        };
+
+IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_BEGIN
+        //While the records of one window are parsed the kernel reads the next one,
+        //and the pages of the windows already parsed are released, so that about
+        //three windows of the file are resident at a time.
+        template <typename Alloc, typename Parser,
+                  typename Record = std::remove_cvref_t<decltype(std::declval<const Parser&>()(std::string_view{}).first)>
+        > Generator<Record> mappedRecords(std::allocator_arg_t, Alloc, MappedFile file, Parser parser, std::size_t window)
+        {
+            const auto contents = file.contents();
+            auto released = std::size_t{ 0 };
+            auto nextWindow = std::size_t{ 0 };
+            for (auto pos = std::size_t{ 0 }; pos < contents.size(); ) {
+                if (pos >= nextWindow) {
+                    file.prefetch(pos, 2 * window);
+                    if (pos >= released + window) {
+                        file.release(released, pos - window - released);
+                        released = pos - window;
+                    }
+                    nextWindow = pos + window;
+                }
+                auto [record, consumed] = (invoke)(parser, contents.substr(pos));
+                pos += std::max(consumed, std::size_t{ 1 });
+                co_yield record;
+            }
+        }
+
+        template <typename Alloc>
+        Generator<std::span<const std::byte>> chunks(std::allocator_arg_t, Alloc alloc, int fd, std::size_t chunkSize)
+        {
+            using Buffer = std::vector<std::byte, typename std::allocator_traits<Alloc>::template rebind_alloc<std::byte>>;
+
+            auto buffer = Buffer(chunkSize, alloc);
+            auto offset = ::lseek(fd, 0, SEEK_CUR);
+            if (offset >= 0) {
+                ::posix_fadvise(fd, offset, 0, POSIX_FADV_SEQUENTIAL);
+            }
+            while (true) {
+                if (offset >= 0) {
+                    ::posix_fadvise(fd, offset + static_cast<off_t>(chunkSize), static_cast<off_t>(chunkSize), POSIX_FADV_WILLNEED);
+                }
+                const auto n = ::read(fd, buffer.data(), chunkSize);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throwSystemError("read");
+                }
+                if (n == 0) {
+                    break;
+                }
+                if (offset >= 0) {
+                    offset += n;
+                }
+                co_yield std::span<const std::byte>{ buffer.data(), static_cast<std::size_t>(n) };
+            }
+        }
+IDRAGNEV_FUNCTIONAL_ALLOCATING_COROUTINES_END
+    } //namespace Detail
+
+    //a record parser yielding the lines of a text without their '\n'
+    inline constexpr auto lines = [](std::string_view rest) noexcept
+    {
+        const auto end = rest.find('\n');
+        return end == std::string_view::npos ? std::pair{ rest, rest.size() } : std::pair{ rest.substr(0, end), end + 1 };
+    };
+
+    //The records of the file at path, parser(rest) returning the next record at the start of rest
+    //and the number of bytes it takes. The file is mapped when mmapSource is called and unmapped
+    //with the generator, so records viewing the mapped bytes, such as those of lines, stay valid until then.
+    template <typename Parser, typename Alloc = std::allocator<std::byte>>
+    auto mmapSource(const std::string& path, Parser parser, std::size_t readahead = defaultReadahead, const Alloc& alloc = {})
+    {
+        return Detail::mappedRecords(std::allocator_arg, alloc, Detail::MappedFile{ path }, std::move(parser), std::max(readahead, std::size_t{ 1 }));
+    }
+
+    //The contents of fd from its current offset in chunks of at most chunkSize bytes,
+    //read into a single buffer. A chunk is valid until the generator is resumed
+    //and fd, which is not closed, must stay open until then.
+    template <typename Alloc = std::allocator<std::byte>>
+    auto chunkedReader(int fd, std::size_t chunkSize, const Alloc& alloc = {})
+    {
+        return Detail::chunks(std::allocator_arg, alloc, fd, std::max(chunkSize, std::size_t{ 1 }));
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "invoke.hpp"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace IDragnev::Functional
+{
+    namespace Detail
+    {
+        template <typename T>
+        constexpr auto toIntegral(T x) noexcept
+        {
+            if constexpr (std::is_enum_v<T>) {
+                return static_cast<std::underlying_type_t<T>>(x);
+            }
+            else {
+                return x;
+            }
+        }
+
+        template <typename Domain, Domain Lo, typename R, std::size_t N>
+        class Tabulated
+        {
+        public:
+            template <typename F>
+            consteval Tabulated(const F& f)
+                : table(make(f, std::make_index_sequence<N>{}))
+            {
+            }
+
+            //a single load, x must lie within the tabulated domain
+            constexpr const R& operator()(Domain x) const noexcept
+            {
+                const auto i = static_cast<long long>(toIntegral(x)) - static_cast<long long>(toIntegral(Lo));
+                assert(i >= 0 && i < static_cast<long long>(N));
+                return table[static_cast<std::size_t>(i)];
+            }
+
+        private:
+            template <typename F, std::size_t... Is>
+            static consteval std::array<R, N> make(const F& f, std::index_sequence<Is...>)
+            {
+                return { R((invoke)(f, static_cast<Domain>(toIntegral(Lo) + static_cast<long long>(Is))))... };
+            }
+
+            std::array<R, N> table;
+        };
+    } //namespace Detail
+
+    //the results of f over the whole of [Lo, Hi], an integral or enumeration range, computed at compile time
+    template <auto Lo, auto Hi, typename F>
+    consteval auto tabulate(const F& f)
+    {
+        using Domain = decltype(Lo);
+        static_assert(std::is_same_v<Domain, decltype(Hi)>, "The bounds of the domain must have the same type");
+        static_assert(std::is_integral_v<Domain> || std::is_enum_v<Domain>, "Only integral and enumeration domains can be tabulated");
+        static_assert(static_cast<long long>(Detail::toIntegral(Lo)) <= static_cast<long long>(Detail::toIntegral(Hi)),
+                      "The domain must not be empty");
+        static_assert(std::is_invocable_v<const F&, Domain>, "f is not invocable with the domain type");
+
+        using R = std::decay_t<std::invoke_result_t<const F&, Domain>>;
+        constexpr auto size = static_cast<std::size_t>(static_cast<long long>(Detail::toIntegral(Hi)) -
+                                                       static_cast<long long>(Detail::toIntegral(Lo))) + 1;
+        return Detail::Tabulated<Domain, Lo, R, size>{ f };
+    }
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "invoke.hpp"
+#include "function.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    //A fixed set of workers, each with its own deque of tasks.
+    //A worker takes the newest task of its own deque and, when it runs out of work,
+    //steals the oldest task of another worker, so that nested fork-join work stays local
+    //while the big pieces spread between the workers.
+    class ThreadPool
+    {
+    private:
+        using Task = Function<void()>;
+
+        struct Queue
+        {
+            std::mutex guard;
+            std::deque<Task> tasks;
+        };
+
+    public:
+        explicit ThreadPool(std::size_t workerCount = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            workerCount = std::max<std::size_t>(1, workerCount);
+            queues.reserve(workerCount);
+            for (auto i = std::size_t{ 0 }; i < workerCount; ++i) {
+                queues.push_back(std::make_unique<Queue>());
+            }
+            workers.reserve(workerCount);
+            for (auto i = std::size_t{ 0 }; i < workerCount; ++i) {
+                workers.emplace_back([this, i] { work(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        //the pending tasks are run before the workers are joined
+        ~ThreadPool()
+        {
+            {
+                auto lock = std::lock_guard{ sleepGuard };
+                stopping = true;
+            }
+            wakeUp.notify_all();
+            workers.clear();
+        }
+
+        std::size_t size() const noexcept { return queues.size(); }
+
+        //tasks posted by a worker go to its own deque, the rest are spread round-robin.
+        //An exception escaping f does not stop the worker, see rethrowPostedException
+        template <typename F>
+        void post(F&& f)
+        {
+            const auto index = currentPool == this ? currentIndex : nextQueue++ % queues.size();
+            //counted before it is published, so a worker taking it cannot make pending wrap around
+            {
+                auto lock = std::lock_guard{ sleepGuard };
+                ++pending;
+                if (waiting > 0) {
+                    progress.notify_all();
+                }
+            }
+            {
+                auto lock = std::lock_guard{ queues[index]->guard };
+                queues[index]->tasks.emplace_back(std::forward<F>(f));
+            }
+            wakeUp.notify_one();
+        }
+
+        template <typename F>
+        auto submit(F f) -> std::future<std::invoke_result_t<F&>>
+        {
+            using R = std::invoke_result_t<F&>;
+            auto promise = std::promise<R>{};
+            auto result = promise.get_future();
+            post([f = std::move(f), promise = std::move(promise)]() mutable
+            {
+                try {
+                    if constexpr (std::is_void_v<R>) {
+                        (invoke)(f);
+                        promise.set_value();
+                    }
+                    else {
+                        promise.set_value((invoke)(f));
+                    }
+                }
+                catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+            });
+            return result;
+        }
+
+        //runs one pending task on the calling thread, if there is any,
+        //which lets a thread waiting on the pool help instead of block
+        bool tryRunPendingTask()
+        {
+            const auto first = currentPool == this ? currentIndex : std::size_t{ 0 };
+            if (auto task = take(first)) {
+                run(*task);
+                return true;
+            }
+            return false;
+        }
+
+        //waits for the future of a task submitted to the pool, running pending tasks in the meantime
+        //and sleeping while there are none until another task is posted or one is done
+        template <typename T>
+        void wait(const std::future<T>& future)
+        {
+            using namespace std::chrono_literals;
+            while (true) {
+                const auto seen = completed.load();
+                if (future.wait_for(0s) == std::future_status::ready) {
+                    return;
+                }
+                if (tryRunPendingTask()) {
+                    continue;
+                }
+                auto lock = std::unique_lock{ sleepGuard };
+                ++waiting;
+                progress.wait(lock, [this, seen] { return completed != seen || pending > 0; });
+                --waiting;
+            }
+        }
+
+        //rethrows the first exception which escaped a task given to post, if there was one since the last call
+        void rethrowPostedException()
+        {
+            auto error = std::exception_ptr{};
+            {
+                auto lock = std::lock_guard{ sleepGuard };
+                error = std::exchange(postedException, nullptr);
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        //the newest task of queues[own] or else the oldest task of another queue
+        std::optional<Task> take(std::size_t own)
+        {
+            for (auto i = std::size_t{ 0 }; i < queues.size(); ++i) {
+                auto& queue = *queues[(own + i) % queues.size()];
+                auto lock = std::lock_guard{ queue.guard };
+                if (!queue.tasks.empty()) {
+                    auto task = std::optional<Task>{};
+                    if (i == 0) {
+                        task.emplace(std::move(queue.tasks.back()));
+                        queue.tasks.pop_back();
+                    }
+                    else {
+                        task.emplace(std::move(queue.tasks.front()));
+                        queue.tasks.pop_front();
+                    }
+                    --pending;
+                    return task;
+                }
+            }
+            return std::nullopt;
+        }
+
+        void run(Task& task) noexcept
+        {
+            try {
+                task();
+            }
+            catch (...) {
+                auto lock = std::lock_guard{ sleepGuard };
+                if (!postedException) {
+                    postedException = std::current_exception();
+                }
+            }
+            //the seq_cst pair completed/waiting makes either this see the waiter or the waiter see the count
+            ++completed;
+            if (waiting > 0) {
+                auto lock = std::lock_guard{ sleepGuard };
+                progress.notify_all();
+            }
+        }
+
+        void work(std::size_t index)
+        {
+            currentPool = this;
+            currentIndex = index;
+            while (true) {
+                if (auto task = take(index)) {
+                    run(*task);
+                    continue;
+                }
+                auto lock = std::unique_lock{ sleepGuard };
+                if (stopping && pending == 0) {
+                    return;
+                }
+                wakeUp.wait(lock, [this] { return stopping || pending > 0; });
+            }
+        }
+
+        static inline thread_local ThreadPool* currentPool = nullptr;
+        static inline thread_local std::size_t currentIndex = 0;
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::atomic<std::size_t> nextQueue = 0;
+        std::atomic<std::size_t> pending = 0;
+        std::atomic<std::size_t> completed = 0;
+        std::atomic<std::size_t> waiting = 0;
+        std::mutex sleepGuard;
+        std::condition_variable wakeUp;
+        std::condition_variable progress;
+        std::exception_ptr postedException;
+        bool stopping = false;
+        std::vector<std::jthread> workers;
+    };
+} //namespace IDragnev::Functional
\ No newline at end of file
@@ -0,0 +1,7 @@
+//The explicit instantiations declared by include/instantiations.hpp
+//when IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES is defined.
+
+#include "include/batch.hpp"
+
+IDRAGNEV_FUNCTIONAL_FOR_EACH_APPLY_KERNEL(IDRAGNEV_FUNCTIONAL_APPLY_KERNEL)
+IDRAGNEV_FUNCTIONAL_FOR_EACH_MASK_KERNEL(IDRAGNEV_FUNCTIONAL_MASK_KERNEL)
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Measures the compile-time cost of the library's templates.
+
+Generates translation units of growing size (compose of N functions,
+firstOf with N overloads, curry and curryN of N-ary functions, N kernels
+of the sections with and without IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES), compiles each of them
+and records the wall time and the peak memory of the compiler.
+
+    tests/compileTimeBenchmark.py --compiler g++ --json results.json
+    tests/compileTimeBenchmark.py --baseline results.json
+
+With --baseline, every case which got slower or hungrier than the given
+threshold is reported and the script exits with a non-zero status.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PRELUDE = """#include "include/functional.hpp"
+using namespace IDragnev::Functional;
+"""
+
+BATCH_PRELUDE = """#include "include/functional.hpp"
+#include "include/batch.hpp"
+#include <span>
+#include <vector>
+using namespace IDragnev::Functional;
+"""
+
+
+def header_only(_):
+    return PRELUDE + "int main() { return 0; }\n"
+
+
+def compose_of(n):
+    funs = ",\n        ".join(f"[](auto x) {{ return x + {i}; }}" for i in range(n))
+    return PRELUDE + f"""
+int main()
+{{
+    const auto f = compose(
+        {funs}
+    );
+    return f(0) == 0;
+}}
+"""
+
+
+def first_of(n):
+    types = "\n".join(f"struct T{i} {{ }};" for i in range(n))
+    overloads = ",\n        ".join(f"[](T{i}) {{ return {i}; }}" for i in range(n))
+    calls = " + ".join(f"f(T{i}{{}})" for i in range(0, n, max(1, n // 8)))
+    return PRELUDE + f"""
+{types}
+
+int main()
+{{
+    const auto f = firstOf(
+        {overloads}
+    );
+    return f(T{n - 1}{{}}) + {calls};
+}}
+"""
+
+
+def curry_of(n):
+    params = ", ".join(f"auto x{i}" for i in range(n))
+    body = " + ".join(f"x{i}" for i in range(n))
+    one_by_one = "".join(f"({i})" for i in range(n))
+    all_at_once = ", ".join(str(i) for i in range(n))
+    return PRELUDE + f"""
+int main()
+{{
+    const auto f = curry([]({params}) {{ return {body}; }});
+    return f{one_by_one} == f({all_at_once});
+}}
+"""
+
+
+def curry_n_of(n):
+    params = ", ".join(f"auto x{i}" for i in range(n))
+    body = " + ".join(f"x{i}" for i in range(n))
+    one_by_one = "".join(f"({i})" for i in range(n))
+    all_at_once = ", ".join(str(i) for i in range(n))
+    return PRELUDE + f"""
+int main()
+{{
+    const auto f = curryN<{n}>([]({params}) {{ return {body}; }});
+    return f{one_by_one} == f({all_at_once});
+}}
+"""
+
+
+SECTION_KERNELS = [
+    (f"{section}({value})", kernel, type_)
+    for type_, value in [("int", "3"), ("long", "3L"), ("float", "3.0f"), ("double", "3.0")]
+    for section, kernel in [("plus", "apply"), ("minus", "apply"), ("times", "apply"), ("divided", "apply"),
+                            ("equals", "mask"), ("differs", "mask"), ("lessThan", "mask"),
+                            ("greaterThan", "mask"), ("lessOrEqualTo", "mask"), ("greaterOrEqualTo", "mask")]
+]
+
+
+def sections_of(n, prelude=BATCH_PRELUDE):
+    calls = []
+    for section, kernel, type_ in SECTION_KERNELS[:n]:
+        if kernel == "apply":
+            calls.append(f"{section}.apply(std::span<const {type_}>{{ in_{type_} }}, std::span{{ out_{type_} }});")
+        else:
+            calls.append(f"count += {section}.mask(in_{type_}).count();")
+    vectors = "\n    ".join(f"auto in_{t} = std::vector<{t}>(100); auto out_{t} = in_{t};" for t in ["int", "long", "float", "double"])
+    body = "\n    ".join(calls)
+    return prelude + f"""
+int main()
+{{
+    {vectors}
+    auto count = std::size_t{{ 0 }};
+    {body}
+    return static_cast<int>(count);
+}}
+"""
+
+
+def sections_extern_of(n):
+    return sections_of(n, "#define IDRAGNEV_FUNCTIONAL_EXTERN_TEMPLATES\n" + BATCH_PRELUDE)
+
+
+CASES = {
+    "header": (header_only, [0]),
+    "compose": (compose_of, [8, 32, 128]),
+    "firstOf": (first_of, [8, 32, 128]),
+    "curry": (curry_of, list(range(2, 11))),
+    "curryN": (curry_n_of, list(range(2, 11))),
+    "sections": (sections_of, [10, 20, 40]),
+    "sectionsExtern": (sections_extern_of, [10, 20, 40]),
+}
+
+
+def compile_once(compiler, flags, source):
+    command = [compiler, *flags, "-I", REPO_ROOT, "-c", source, "-o", os.devnull]
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stderr=subprocess.PIPE)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.perf_counter() - start
+    errors = process.stderr.read().decode()
+    process.stderr.close()
+    if os.waitstatus_to_exitcode(status) != 0:
+        raise RuntimeError(f"compilation of {source} failed:\n{errors}")
+    # ru_maxrss is in kilobytes on Linux and in bytes on macOS
+    peak_kb = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return elapsed, peak_kb
+
+
+def measure(compiler, flags, source, repeat):
+    runs = [compile_once(compiler, flags, source) for _ in range(repeat)]
+    return min(t for t, _ in runs), max(m for _, m in runs)
+
+
+def run_cases(args, directory):
+    results = {}
+    for name, (generate, sizes) in CASES.items():
+        if args.cases and name not in args.cases:
+            continue
+        for n in sizes:
+            source = os.path.join(directory, f"{name}{n}.cpp")
+            with open(source, "w") as file:
+                file.write(generate(n))
+            seconds, peak_kb = measure(args.compiler, args.flags, source, args.repeat)
+            key = f"{name}/{n}"
+            results[key] = {"seconds": seconds, "peakKiB": peak_kb}
+            print(f"{key:<14} {seconds:8.3f} s {peak_kb / 1024:10.1f} MiB", flush=True)
+    return results
+
+
+def regressions(results, baseline, threshold):
+    found = []
+    for key, current in results.items():
+        previous = baseline.get(key)
+        if previous is None:
+            continue
+        for metric in ("seconds", "peakKiB"):
+            if current[metric] > previous[metric] * (1 + threshold):
+                found.append(f"{key}: {metric} {previous[metric]:.3f} -> {current[metric]:.3f}")
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "g++"))
+    parser.add_argument("--flags", nargs="*", default=["-std=c++20", "-O0"])
+    parser.add_argument("--repeat", type=int, default=3, help="compilations per case, the fastest one is kept")
+    parser.add_argument("--cases", nargs="*", choices=list(CASES), help="run only the given cases")
+    parser.add_argument("--json", help="write the results to this file")
+    parser.add_argument("--baseline", help="compare against results written by an earlier --json run")
+    parser.add_argument("--threshold", type=float, default=0.10, help="allowed relative growth, 0.10 = 10%%")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        results = run_cases(args, directory)
+
+    if args.json:
+        with open(args.json, "w") as file:
+            json.dump({"compiler": args.compiler, "flags": args.flags, "results": results}, file, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)["results"]
+        found = regressions(results, baseline, args.threshold)
+        for line in found:
+            print(f"regression: {line}")
+        return 1 if found else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
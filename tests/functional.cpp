@@ -2,6 +2,24 @@
 #include "doctest.h"
 
 #include "include/functional.hpp"
+#include "include/pipeline.hpp"
+#include "include/parallel.hpp"
+#include "include/async.hpp"
+#include "include/generator.hpp"
+#include "include/memoize.hpp"
+#include "include/tabulate.hpp"
+#include "include/function.hpp"
+#include "include/allocated.hpp"
+#include "include/match.hpp"
+#include "include/dispatch.hpp"
+#include "include/instrument.hpp"
+#include "include/simplify.hpp"
+#include "include/placeholders.hpp"
+#include "include/batch.hpp"
+#include "include/columns.hpp"
+#include "include/fix.hpp"
+#include "include/source.hpp"
+#include "include/batched.hpp"
 #include <algorithm>
 #include <functional>
 #include <numeric>
@@ -9,10 +27,61 @@
 #include <vector>
 #include <array>
 #include <forward_list>
+#include <span>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <memory_resource>
+#include <variant>
+#include <thread>
+#include <limits>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std::string_literals;
 using namespace IDragnev::Functional;
 
+struct Counter
+{
+    Counter(int& copies, int& moves) : copies(&copies), moves(&moves) { }
+    Counter(const Counter& other) : copies(other.copies), moves(other.moves) { ++*copies; }
+    Counter(Counter&& other) noexcept : copies(other.copies), moves(other.moves) { ++*moves; }
+
+    int* copies;
+    int* moves;
+};
+
+//cents, adding to which throws when the sum would overflow
+struct Money
+{
+    int cents;
+};
+
+inline Money operator+(Money lhs, int rhs)
+{
+    if (rhs > 0 && lhs.cents > std::numeric_limits<int>::max() - rhs) {
+        throw std::overflow_error{ "Money overflow" };
+    }
+    return Money{ lhs.cents + rhs };
+}
+
+struct Word
+{
+    std::string text;
+
+    std::size_t length() const { return text.size(); }
+    friend bool operator==(const Word&, const Word&) = default;
+};
+
+template <>
+struct std::hash<Word>
+{
+    std::size_t operator()(const Word& w) const noexcept { return std::hash<std::string>{}(w.text); }
+};
+
 TEST_CASE("invoke")
 {
     SUBCASE("with member function")
@@ -106,6 +175,46 @@ TEST_CASE("plus")
         CHECK(result == "123456"s);
         CHECK(source == ""s);
     }
+
+    SUBCASE("binding moves the argument once")
+    {
+        auto copies = 0;
+        auto moves = 0;
+
+        [[maybe_unused]] const auto f = plus(Counter{ copies, moves });
+
+        CHECK(copies == 0);
+        CHECK(moves == 1);
+    }
+}
+
+TEST_CASE("operator sections")
+{
+    SUBCASE("sections are stored without overhead")
+    {
+        static_assert(std::is_empty_v<decltype(plus)>);
+        static_assert(sizeof(times(5)) == sizeof(int));
+        static_assert(sizeof(lessThan(0.0)) == sizeof(double));
+    }
+
+    SUBCASE("computing at compile time")
+    {
+        constexpr auto table = std::array{ times(2), times(3), times(4) };
+
+        static_assert(table[1](5) == 15);
+        static_assert(lessThan(0)(-1));
+        static_assert(!greaterOrEqualTo(1)(0));
+        static_assert(mod(3)(7) == 1);
+    }
+
+    SUBCASE("sections are SFINAE-friendly")
+    {
+        using Section = decltype(lessThan(0));
+
+        static_assert(std::is_invocable_v<Section, int>);
+        static_assert(!std::is_invocable_v<Section, std::string>);
+        static_assert(std::is_nothrow_invocable_v<Section, int>);
+    }
 }
 
 TEST_CASE("minus")
@@ -187,6 +296,63 @@ TEST_CASE("superposition")
     {
         static_assert(superpose(std::minus{}, identity, identity)(1) == 0);
     }
+
+    SUBCASE("the functions are stored without copies")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = superpose(std::plus{}, identity, bindFront([](const Counter&, int x) { return x; }, Counter{ copies, moves }));
+
+        CHECK(f(1) == 2);
+        CHECK(copies == 0);
+        static_assert(sizeof(superpose(std::plus{}, std::negate{}, identity)) == 1);
+    }
+
+    SUBCASE("all the functions see rvalue arguments as const lvalues by default")
+    {
+        const auto isConstLvalue = [](auto&& x) { return std::is_same_v<decltype(x), const std::string&>; };
+        const auto f = superpose(std::logical_and{}, isConstLvalue, isConstLvalue);
+
+        CHECK(f("x"s));
+    }
+
+    SUBCASE("the last use may move the arguments")
+    {
+        const auto size = [](const std::vector<int>& v) { return v.size(); };
+        const auto take = [](std::vector<int>&& v) { return std::move(v); };
+        const auto f = superpose(lastUseMoves, [](std::size_t n, std::vector<int> v) { return n == v.size(); }, size, take);
+
+        auto v = std::vector<int>{ 1, 2, 3 };
+        CHECK(f(std::move(v)));
+        CHECK(v.empty());
+
+        auto w = std::vector<int>{ 1 };
+        CHECK(superpose(lastUseMoves, std::equal_to{}, size, size)(w));
+    }
+}
+
+TEST_CASE("lazy superposition")
+{
+    SUBCASE("F decides which results are computed")
+    {
+        auto calls = 0;
+        const auto counted = [&calls](auto x) { ++calls; return x; };
+        const auto firstPositive = [](auto f, auto g) { return f() > 0 ? f() : g(); };
+
+        const auto h = superposeLazy(firstPositive, minus(1), counted);
+
+        CHECK(h(2) == 1);
+        CHECK(calls == 0);
+        CHECK(h(0) == 0);
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("computing at compile time")
+    {
+        constexpr auto sum = [](auto f, auto g) constexpr { return f() + g(); };
+
+        static_assert(superposeLazy(sum, times(2), plus(1))(3) == 10);
+    }
 }
 
 TEST_CASE("composition")
@@ -224,6 +390,43 @@ TEST_CASE("composition")
         constexpr auto minusOne = [](auto x) constexpr { return x - 1; };
 
         static_assert(compose(plusOne, minusOne)(2) == 2);
+        static_assert(compose(plusOne, plusOne, minusOne, identity)(2) == 3);
+    }
+
+    SUBCASE("the composed functions are stored flat")
+    {
+        const auto x = 1;
+        const auto y = 2;
+        const auto plusX = [x](auto z) { return z + x; };
+        const auto plusY = [y](auto z) { return z + y; };
+        const auto twice = [](auto z) { return 2 * z; };
+
+        const auto f = compose(plusX, identity, plusY, twice);
+
+        CHECK(f(3) == 9);
+        static_assert(sizeof(f) == sizeof(plusX) + sizeof(plusY));
+        static_assert(sizeof(compose(identity, twice)) == 1);
+    }
+
+    SUBCASE("composition propagates noexcept")
+    {
+        const auto nothrowF = [](int x) noexcept { return x; };
+        const auto throwingF = [](int x) { return x; };
+
+        static_assert(noexcept(compose(nothrowF, nothrowF, identity)(1)));
+        static_assert(!noexcept(compose(nothrowF, throwingF, identity)(1)));
+    }
+
+    SUBCASE("compositions are invocable only with the arguments the chain accepts")
+    {
+        const auto length = [](const std::string& s) { return s.size(); };
+        using F = decltype(compose(plus(1u), length));
+        using G = decltype(compose(length, plus(1)));
+
+        static_assert(std::is_invocable_v<const F&, std::string>);
+        static_assert(!std::is_invocable_v<const F&, int>);
+        static_assert(!std::is_invocable_v<const G&, int>);
+        static_assert(!std::is_nothrow_invocable_v<const F&, std::string>);
     }
 }
 
@@ -347,6 +550,92 @@ TEST_CASE("curry")
 
         CHECK(fWithBoundX(1, 2) == 13);
     }
+
+    SUBCASE("temporary curried functions move their bound arguments")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = [](const Counter&, int x, int y, int z) { return x + y + z; };
+
+        const auto result = curry(f)(Counter{ copies, moves })(1)(2)(3);
+
+        CHECK(result == 6);
+        CHECK(copies == 0);
+        CHECK(moves == 3);
+    }
+
+    SUBCASE("reusing an lvalue curried function copies its bound arguments")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = [](const Counter&, int x, int y) { return x + y; };
+        const auto bound = curry(f)(Counter{ copies, moves });
+        copies = moves = 0;
+
+        CHECK(bound(1)(2) == 3);
+        CHECK(bound(3, 4) == 7);
+        CHECK(copies == 1);
+        CHECK(moves == 0);
+    }
+
+    SUBCASE("the arity of functions with a single signature is known up front")
+    {
+        struct Point
+        {
+            int x;
+            int shifted(int dx, int dy) const noexcept { return x + dx + dy; }
+        };
+        const auto f = [](int x, int y, int z) { return x * y + z; };
+        const auto p = Point{ 1 };
+
+        static_assert(std::is_same_v<decltype(curry(f)(2)), Detail::CurriedN<2, std::remove_const_t<decltype(f)>, int>>);
+        static_assert(curry([](int x, int y) { return x - y; })(3)(1) == 2);
+        CHECK(curry(f)(2)(3)(4) == 10);
+        CHECK(curry(&Point::shifted)(p)(1, 2) == 4);
+        CHECK(curry(&Point::x)(p) == 1);
+    }
+
+    SUBCASE("members qualified with volatile have a known arity too")
+    {
+        struct Register
+        {
+            int value;
+            int read(int offset) volatile { return value + offset; }
+            int peek(int offset) const volatile& noexcept { return value + offset; }
+            int take(int offset) const volatile&& { return value + offset; }
+        };
+        auto r = Register{ 1 };
+
+        static_assert(std::is_same_v<Detail::CallableTraits<decltype(&Register::read)>::Arguments, std::tuple<volatile Register&, int>>);
+        static_assert(std::is_same_v<Detail::CallableTraits<decltype(&Register::peek)>::Arguments, std::tuple<const volatile Register&, int>>);
+        static_assert(Detail::CallableTraits<decltype(&Register::take)>::arity == 2);
+        CHECK(curry(&Register::read)(r)(2) == 3);
+        CHECK(curry(&Register::read)(std::ref(r))(3) == 4);
+    }
+
+    SUBCASE("curryN invokes the function once it has N arguments")
+    {
+        const auto f = [](int x, int y = 10) { return x + y; };
+        const auto sum = [](auto... xs) { return (0 + ... + xs); };
+
+        CHECK(curryN<1>(f)(1) == 11);
+        CHECK(curryN<2>(f)(1)(2) == 3);
+        CHECK(curryN<3>(sum)(1)(2)(3) == 6);
+        CHECK(curryN<3>(sum)(1, 2)(3) == 6);
+        CHECK(curryN<0>(sum)() == 0);
+        static_assert(!std::is_invocable_v<decltype(curryN<2>(f)), int, int, int>);
+    }
+
+    SUBCASE("curryN moves and copies the bound arguments as curry does")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = [](const Counter&, int x, int y) { return x + y; };
+
+        CHECK(curryN<3>(f)(Counter{ copies, moves })(1)(2) == 3);
+        CHECK(copies == 0);
+        CHECK(moves == 2);
+    }
 }
 
 TEST_CASE("flip")
@@ -413,6 +702,32 @@ TEST_CASE("allOf and anyOf")
     {
         static_assert(anyOf(isPositive, isEven)(-2));
     }
+    SUBCASE("allOf, anyOf and noneOf short-circuit")
+    {
+        auto calls = 0;
+        const auto counted = [&calls](auto x) { ++calls; return x > 100; };
+
+        CHECK(!allOf(isPositive, counted)(-1));
+        CHECK(anyOf(isEven, counted)(2));
+        CHECK(!noneOf(isEven, counted)(2));
+        CHECK(calls == 0);
+
+        CHECK(!allOf(isPositive, counted, counted)(1));
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("noneOf can compute at compile time")
+    {
+        static_assert(noneOf(isPositive, isEven)(-1));
+    }
+
+    SUBCASE("combining predicates propagates noexcept")
+    {
+        const auto throwingPredicate = [](int x) { return x > 0; };
+
+        static_assert(noexcept(allOf(lessThan(1), greaterThan(-1))(0)));
+        static_assert(!noexcept(anyOf(lessThan(1), throwingPredicate)(0)));
+    }
 }
 
 TEST_CASE("bindFront")
@@ -442,6 +757,54 @@ TEST_CASE("bindFront")
 
         CHECK(result == std::vector{4, 5, 6});
     }
+    SUBCASE("calling a temporary hands the bound arguments over")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = [](Counter, int x) { return x; };
+
+        CHECK(bindFront(f, Counter{ copies, moves })(1) == 1);
+        CHECK(copies == 0);
+        CHECK(moves == 2);
+    }
+
+    SUBCASE("an lvalue copies the bound arguments only for callees taking them by value")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto byValue = bindFront([](Counter, int x) { return x; }, Counter{ copies, moves });
+        const auto byReference = bindFront([](const Counter&, int x) { return x; }, Counter{ copies, moves });
+
+        CHECK(byReference(1) == 1);
+        CHECK(copies == 0);
+        CHECK(byValue(1) == 1);
+        CHECK(copies == 1);
+    }
+}
+
+TEST_CASE("bindFrontRef")
+{
+    SUBCASE("the bound arguments are not copied")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto key = Counter{ copies, moves };
+        const auto isKey = bindFrontRef([](const Counter& x, const Counter* y) { return &x == y; }, key);
+
+        CHECK(isKey(&key));
+        CHECK(copies == 0);
+        CHECK(moves == 0);
+    }
+
+    SUBCASE("the bound arguments are seen by reference")
+    {
+        auto x = 1;
+        const auto plusX = bindFrontRef(std::plus{}, x);
+
+        CHECK(plusX(1) == 2);
+        x = 10;
+        CHECK(plusX(1) == 11);
+    }
 }
 
 TEST_CASE("firstOf")
@@ -490,4 +853,1593 @@ TEST_CASE("firstOf")
         static_assert(f(1) == 1);
         static_assert(f(Third{}) == 3);
     }
-}
\ No newline at end of file
+
+    SUBCASE("a deleted overload is passed over by the later ones")
+    {
+        constexpr auto f = firstOf(
+            Deleted([](int) { return 1; }),
+            [](auto) { return 2; }
+        );
+
+        static_assert(f(1) == 2);
+    }
+
+    SUBCASE("no bigger than the stateful overloads")
+    {
+        const auto k = 5;
+        const auto f = firstOf([](First) { return 1; }, [k](Second) { return k; }, [](Third) noexcept { return 3; });
+
+        static_assert(sizeof(f) == sizeof(int));
+        static_assert(noexcept(f(Third{})) && !noexcept(f(First{})));
+        CHECK(f(Second{}) == 5);
+    }
+}
+
+TEST_CASE("batched sections")
+{
+    SUBCASE("apply computes the section over a whole range")
+    {
+        auto in = std::vector<float>(103);
+        std::iota(in.begin(), in.end(), 0.0f);
+        auto out = std::vector<float>(in.size());
+
+        times(2).apply(std::span<const float>{ in }, std::span{ out });
+
+        for (auto i = std::size_t{ 0 }; i < in.size(); ++i) {
+            CHECK(out[i] == 2 * in[i]);
+        }
+    }
+
+    SUBCASE("apply works in place and with non-arithmetic types")
+    {
+        auto nums = std::vector<int>{ 1, 2, 3 };
+        auto strings = std::vector<std::string>{ "a", "b" };
+
+        minus(1).apply(nums, nums);
+        plus("!"s).apply(strings, strings);
+
+        CHECK(nums == std::vector<int>{ 0, 1, 2 });
+        CHECK(strings == std::vector<std::string>{ "a!", "b!" });
+    }
+
+    SUBCASE("mutable spans are accepted as inputs")
+    {
+        auto nums = std::vector<int>{ 1, 2, 3, 4 };
+        auto out = std::vector<int>(nums.size());
+        const auto in = std::span{ nums };
+
+        times(5).apply(in, out);
+
+        CHECK(out == std::vector<int>{ 5, 10, 15, 20 });
+        CHECK(lessThan(2).mask(in).selection() == std::vector<std::size_t>{ 0 });
+        CHECK(allOf(greaterThan(1), lessThan(4)).mask(in).selection() == std::vector<std::size_t>{ 1, 2 });
+        CHECK(anyOf(lessThan(2), greaterThan(3)).mask(in).selection() == std::vector<std::size_t>{ 0, 3 });
+        CHECK(inverse(lessThan(2)).mask(in).count() == 3);
+    }
+
+    SUBCASE("apply rejects an output shorter than its input")
+    {
+        const auto nums = std::vector<int>{ 1, 2, 3 };
+        auto out = std::vector<int>(nums.size() - 1);
+
+        CHECK_THROWS_AS(plus(1).apply(nums, out), std::invalid_argument);
+        CHECK_THROWS_AS(times(2.0f).apply(std::vector<float>(100), std::vector<float>(99)), std::invalid_argument);
+    }
+
+    SUBCASE("mask sets the bits of the elements satisfying the section")
+    {
+        auto nums = std::vector<int>(200);
+        std::iota(nums.begin(), nums.end(), -100);
+
+        const auto mask = lessThan(0).mask(std::span<const int>{ nums });
+
+        CHECK(mask.size() == nums.size());
+        CHECK(mask.count() == 100);
+        for (auto i = std::size_t{ 0 }; i < nums.size(); ++i) {
+            CHECK(mask[i] == (nums[i] < 0));
+        }
+    }
+
+    SUBCASE("combined predicates are masked block by block")
+    {
+        auto nums = std::vector<int>(10'000);
+        std::iota(nums.begin(), nums.end(), -5'000);
+        const auto isOdd = [](int x) { return x % 2 != 0; };
+
+        const auto all = allOf(greaterThan(-100), lessThan(100), isOdd).mask(nums);
+        const auto any = anyOf(lessThan(-4'990), greaterThan(4'990)).mask(nums);
+        const auto none = noneOf(lessThan(-4'990), greaterThan(4'990)).mask(nums);
+
+        for (auto i = std::size_t{ 0 }; i < nums.size(); ++i) {
+            const auto x = nums[i];
+            CHECK(all[i] == (x > -100 && x < 100 && isOdd(x)));
+            CHECK(any[i] == (x < -4'990 || x > 4'990));
+        }
+        CHECK(none == ~any);
+        CHECK(inverse(isOdd).mask(nums).count() == 5'000);
+    }
+
+    SUBCASE("combinations of no predicates are masked by their identities")
+    {
+        const auto nums = std::vector<int>{ 1, 2, 3 };
+
+        CHECK(allOf().mask(nums) == Bitmask(3, true));
+        CHECK(anyOf().mask(nums) == Bitmask(3));
+        CHECK(noneOf().mask(nums) == Bitmask(3, true));
+        CHECK(allOf(blockwise).mask(nums).count() == 3);
+        CHECK(allOf(blockwise)(1));
+        CHECK(!anyOf(blockwise)(1));
+    }
+
+    SUBCASE("the selection of a mask lists the positions of its set bits")
+    {
+        const auto nums = std::vector<double>{ 3.0, -1.0, 7.0, 0.5, 9.0 };
+        const auto mask = allOf(blockwise, greaterThan(1.0), lessThan(8.0)).mask(nums);
+
+        CHECK(mask.selection() == std::vector<std::size_t>{ 0, 2 });
+        CHECK(Bitmask(130, true).selection().size() == 130);
+        CHECK(Bitmask(10).selection().empty());
+    }
+
+    SUBCASE("blockwise combinations evaluate every predicate per row")
+    {
+        auto calls = 0;
+        const auto counted = [&calls](int) { ++calls; return true; };
+
+        CHECK(!allOf(blockwise, lessThan(0), counted)(1));
+        CHECK(anyOf(blockwise, greaterThan(0), counted)(1));
+        CHECK(calls == 2);
+        CHECK(noneOf(blockwise, lessThan(0), greaterThan(5))(3));
+        static_assert(allOf(blockwise, greaterThan(0), lessThan(5))(3));
+    }
+
+    SUBCASE("masks can be combined")
+    {
+        const auto nums = std::vector<double>{ -2.0, -1.0, 0.0, 1.0, 2.0 };
+
+        const auto mask = greaterThan(-2).mask(nums) & ~greaterOrEqualTo(1.0).mask(nums);
+
+        CHECK(mask.count() == 2);
+        CHECK(!mask[0]);
+        CHECK(mask[1]);
+        CHECK(mask[2]);
+        CHECK(!mask[3]);
+    }
+}
+
+
+TEST_CASE("pipeline")
+{
+    const auto nums = std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    SUBCASE("basics")
+    {
+        const auto sumOfFirstOdd = filter(inverse(compose(equals(0), mod(2)))) | take(3) | fold(std::plus{}, 0);
+
+        CHECK(sumOfFirstOdd(nums) == 1 + 3 + 5);
+        CHECK(sumOfFirstOdd(nums.cbegin(), nums.cbegin() + 3) == 1 + 3);
+    }
+
+    SUBCASE("pipelines without a fold write to an output iterator")
+    {
+        auto result = std::vector<std::string>{};
+        const auto toString = [](auto x) { return std::to_string(x); };
+
+        const auto p = filter(greaterThan(7)) | map(toString) | map(plus("!"));
+        p(std::span{ nums }, std::back_inserter(result));
+
+        CHECK(result == std::vector<std::string>{ "8!", "9!", "10!" });
+    }
+
+    SUBCASE("adjacent maps and filters are fused")
+    {
+        const auto maps = map(times(2)) | map(plus(1)) | map(minus(3));
+        const auto filters = filter(greaterThan(2)) | filter(lessThan(9)) | filter(differs(5));
+        using Fused = decltype(map(compose(minus(3), plus(1), times(2))));
+
+        static_assert(sizeof(maps) == sizeof(Fused));
+        CHECK((maps | fold(std::plus{}, 0))(nums) == 2 * 55 - 2 * 10);
+        CHECK((filters | fold(std::plus{}, 0))(nums) == 3 + 4 + 6 + 7 + 8);
+    }
+
+    SUBCASE("take stops the iteration")
+    {
+        auto calls = 0;
+        const auto counted = [&calls](auto x) { ++calls; return x; };
+
+        const auto sum = (map(counted) | take(2) | fold(std::plus{}, 0))(nums);
+
+        CHECK(sum == 3);
+        CHECK(calls == 2);
+        CHECK((take(0) | fold(std::plus{}, 0))(nums) == 0);
+    }
+
+    SUBCASE("take(0) pulls nothing")
+    {
+        auto calls = 0;
+        const auto counted = [&calls](auto x) { ++calls; return x; };
+        auto result = std::vector<int>{};
+
+        CHECK((map(counted) | take(0) | fold(std::plus{}, 0))(nums) == 0);
+        (map(counted) | take(0))(nums, std::back_inserter(result));
+
+        CHECK(calls == 0);
+        CHECK(result.empty());
+    }
+
+    SUBCASE("computing at compile time")
+    {
+        constexpr int values[] = { 1, 2, 3, 4 };
+        constexpr auto sumOfSquares = map([](int x) constexpr { return x * x; }) | fold(std::plus{}, 0);
+
+        static_assert(sumOfSquares(values) == 30);
+    }
+}
+
+
+TEST_CASE("parallel algorithms")
+{
+    auto nums = std::vector<int>(100'000);
+    std::iota(nums.begin(), nums.end(), 0);
+    const auto policy = Parallel::ParallelPolicy{ 4 };
+
+    SUBCASE("transform")
+    {
+        auto result = std::vector<long long>(nums.size());
+        const auto f = compose(plus(1LL), times(2LL));
+
+        const auto end = Parallel::transform(policy, nums, result.begin(), f);
+        auto expected = std::vector<long long>(nums.size());
+        std::transform(nums.begin(), nums.end(), expected.begin(), f);
+
+        CHECK(end == result.end());
+        CHECK(result == expected);
+        CHECK(Parallel::transform(Parallel::parUnseq, nums, f) == expected);
+        CHECK(Parallel::transform(Parallel::seq, nums, f) == expected);
+        CHECK(Parallel::transform(std::vector<int>{}, f).empty());
+    }
+
+    SUBCASE("forEach")
+    {
+        const auto twice = [](int& x) { x *= 2; };
+        Parallel::forEach(policy, nums, twice);
+
+        CHECK(nums[0] == 0);
+        CHECK(nums[99'999] == 199'998);
+        CHECK(std::count_if(nums.begin(), nums.end(), mod(2)) == 0);
+    }
+
+    SUBCASE("reduce keeps the order of the elements")
+    {
+        const auto sum = Parallel::reduce(policy, nums, 0LL);
+        CHECK(sum == 99'999LL * 100'000 / 2);
+
+        auto words = std::vector<std::string>(20'000);
+        for (auto i = 0u; i < words.size(); ++i) {
+            words[i] = std::to_string(i % 10);
+        }
+        const auto concatenated = std::accumulate(words.begin(), words.end(), std::string{});
+        const auto reversed = std::string(concatenated.rbegin(), concatenated.rend());
+
+        CHECK(Parallel::reduce(policy, words, std::string{}) == concatenated);
+        CHECK(Parallel::reduce(policy, words, std::string{}, flip(std::plus{})) == reversed);
+    }
+
+    SUBCASE("exceptions are propagated to the caller")
+    {
+        const auto throwing = [](int x) { if (x == 77'777) { throw x; } return x; };
+        CHECK_THROWS_AS(Parallel::transform(policy, nums, throwing), int);
+    }
+
+    SUBCASE("only functions safe to share are accepted")
+    {
+        auto counter = 0;
+        const auto stateless = [](int x) mutable { return x; };
+        const auto stateful = [counter](int x) mutable { return x + counter++; };
+
+        static_assert(Detail::isShareable<decltype(stateless), int>);
+        static_assert(!Detail::isShareable<decltype(stateful), int>);
+        static_assert(Detail::isShareable<decltype(matches(1, identity)), int>);
+    }
+}
+
+
+TEST_CASE("thread pool")
+{
+    auto pool = ThreadPool{ 3 };
+
+    SUBCASE("submitted tasks produce futures")
+    {
+        auto first = pool.submit([] { return 1; });
+        auto second = pool.submit([] { return std::string{ "two" }; });
+
+        CHECK(first.get() == 1);
+        CHECK(second.get() == "two");
+    }
+
+    SUBCASE("exceptions are stored in the futures")
+    {
+        auto result = pool.submit([]() -> int { throw std::runtime_error{ "failed" }; });
+        CHECK_THROWS_AS(result.get(), std::runtime_error);
+    }
+
+    SUBCASE("pending tasks are run before the pool is destroyed")
+    {
+        auto count = std::atomic<int>{ 0 };
+        {
+            auto local = ThreadPool{ 2 };
+            for (auto i = 0; i < 100; ++i) {
+                local.post([&count] { ++count; });
+            }
+        }
+        CHECK(count == 100);
+    }
+
+    SUBCASE("exceptions escaping posted tasks are kept for the poster")
+    {
+        auto count = std::atomic<int>{ 0 };
+        {
+            auto single = ThreadPool{ 1 };
+            single.post([] { throw std::runtime_error{ "failed" }; });
+            single.post([&count] { ++count; });
+
+            auto rethrown = false;
+            while (!rethrown) {
+                try {
+                    single.rethrowPostedException();
+                    std::this_thread::yield();
+                }
+                catch (const std::runtime_error&) {
+                    rethrown = true;
+                }
+            }
+            CHECK_NOTHROW(single.rethrowPostedException());
+        }
+        CHECK(count == 1);
+    }
+
+    SUBCASE("waiting helps with the pending tasks")
+    {
+        auto single = ThreadPool{ 1 };
+        auto inner = std::future<int>{};
+        auto outer = single.submit([&single, &inner]
+        {
+            inner = single.submit([] { return 1; });
+            single.wait(inner);
+            return inner.get() + 1;
+        });
+
+        CHECK(outer.get() == 2);
+    }
+}
+
+TEST_CASE("async superposition")
+{
+    auto pool = ThreadPool{ 2 };
+    const auto sum = [](auto... xs) { return (xs + ...); };
+
+    SUBCASE("the results are joined by f")
+    {
+        const auto f = superposeAsync(pool, sum, times(2), plus(5), minus(1), identity);
+        CHECK(f(10) == 20 + 15 + 9 + 10);
+    }
+
+    SUBCASE("can be nested in tasks of the same pool")
+    {
+        auto single = ThreadPool{ 1 };
+        const auto inner = superposeAsync(single, sum, plus(1), plus(2));
+        const auto outer = superposeAsync(single, sum, inner, inner, inner);
+
+        auto result = single.submit([&outer] { return outer(0); });
+        CHECK(result.get() == 9);
+    }
+
+    SUBCASE("exceptions are propagated after all branches are done")
+    {
+        const auto fails = [](int) -> int { throw std::runtime_error{ "failed" }; };
+        CHECK_THROWS_AS(superposeAsync(pool, sum, fails, identity)(1), std::runtime_error);
+        CHECK_THROWS_AS(superposeAsync(pool, sum, identity, fails)(1), std::runtime_error);
+    }
+}
+
+TEST_CASE("async composition")
+{
+    auto pool = ThreadPool{ 2 };
+    const auto toString = [](auto x) { return std::to_string(x); };
+
+    SUBCASE("the functions are chained as continuations")
+    {
+        const auto f = composeAsync(pool, plus("!"s), toString, times(2), plus(1));
+        auto results = std::vector<std::future<std::string>>{};
+        for (auto i = 0; i < 10; ++i) {
+            results.push_back(f(i));
+        }
+
+        CHECK(results[0].get() == "2!");
+        CHECK(results[9].get() == "20!");
+    }
+
+    SUBCASE("the arguments are copied")
+    {
+        auto result = std::future<std::size_t>{};
+        {
+            auto word = "word"s;
+            const auto length = composeAsync(pool, [](const std::string& s) { return s.size(); }, plus("s"s));
+            result = length(word);
+        }
+        CHECK(result.get() == 5);
+    }
+
+    SUBCASE("exceptions are stored in the future")
+    {
+        const auto fails = [](int) -> int { throw std::runtime_error{ "failed" }; };
+        auto result = composeAsync(pool, plus(1), fails)(1);
+        CHECK_THROWS_AS(result.get(), std::runtime_error);
+    }
+}
+
+
+namespace
+{
+    template <typename T>
+    struct CountingAllocator
+    {
+        using value_type = T;
+
+        CountingAllocator(int& allocations) noexcept : allocations(&allocations) { }
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>& other) noexcept : allocations(other.allocations) { }
+
+        T* allocate(std::size_t n)
+        {
+            ++*allocations;
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            --*allocations;
+            std::allocator<T>{}.deallocate(p, n);
+        }
+
+        friend bool operator==(const CountingAllocator&, const CountingAllocator&) = default;
+
+        int* allocations;
+    };
+
+    Generator<int> naturals()
+    {
+        for (auto i = 0;; ++i) {
+            co_yield i;
+        }
+    }
+
+    Generator<int> countedNaturals(int& pulled)
+    {
+        for (auto i = 0;; ++i) {
+            ++pulled;
+            co_yield i;
+        }
+    }
+} //namespace
+
+TEST_CASE("generators")
+{
+    const auto nums = std::vector<int>{ 1, 20, 3, 70, 5, 60 };
+
+    SUBCASE("generate yields the elements of a range")
+    {
+        auto result = std::vector<int>{};
+        for (const auto& x : generate(nums)) {
+            result.push_back(x);
+        }
+        CHECK(result == nums);
+    }
+
+    SUBCASE("pipelines are applied lazily")
+    {
+        auto result = std::vector<int>{};
+        for (auto x : generate(nums) | map(times(2)) | filter(lessThan(100))) {
+            result.push_back(x);
+        }
+        CHECK(result == std::vector<int>{ 2, 40, 6, 10 });
+    }
+
+    SUBCASE("infinite sources are pulled on demand")
+    {
+        const auto isOdd = inverse(compose(equals(0), mod(2)));
+        auto result = std::vector<int>{};
+        for (auto x : naturals() | filter(isOdd) | map(times(3)) | take(3)) {
+            result.push_back(x);
+        }
+
+        CHECK(result == std::vector<int>{ 3, 9, 15 });
+        CHECK((naturals() | take(5) | fold(std::plus{}, 0)) == 10);
+    }
+
+    SUBCASE("take(0) does not resume the source")
+    {
+        auto pulled = 0;
+        CHECK((countedNaturals(pulled) | take(0) | fold(std::plus{}, 0)) == 0);
+
+        auto rest = countedNaturals(pulled) | take(0);
+        CHECK(rest.begin() == rest.end());
+        CHECK(pulled == 0);
+    }
+
+    SUBCASE("generators are ranges")
+    {
+        auto source = generate(std::vector<std::string>{ "a", "bb", "ccc" });
+        const auto length = [](const std::string& s) { return s.size(); };
+        CHECK((map(length) | fold(std::plus{}, std::size_t{ 0 }))(source) == 6);
+    }
+
+    SUBCASE("frames come from the given allocator")
+    {
+        auto allocations = 0;
+        {
+            auto g = generate(nums, CountingAllocator<std::byte>{ allocations });
+            auto p = pipe(std::move(g), map(plus(1)), CountingAllocator<std::byte>{ allocations });
+            CHECK(allocations == 2);
+            CHECK(*p.begin() == 2);
+        }
+        CHECK(allocations == 0);
+
+        std::byte buffer[1024];
+        auto arena = std::pmr::monotonic_buffer_resource{ buffer, sizeof(buffer), std::pmr::null_memory_resource() };
+        auto sum = generate(nums, std::pmr::polymorphic_allocator<>{ &arena }) | fold(std::plus{}, 0);
+        CHECK(sum == 159);
+    }
+
+    SUBCASE("exceptions reach the consumer")
+    {
+        const auto failing = []() -> Generator<int>
+        {
+            co_yield 1;
+            throw std::runtime_error{ "failed" };
+        };
+
+        auto g = failing();
+        auto it = g.begin();
+        CHECK(*it == 1);
+        CHECK_THROWS_AS(++it, std::runtime_error);
+    }
+}
+
+
+TEST_CASE("memoize")
+{
+    auto calls = 0;
+    const auto square = [&calls](int x) { ++calls; return x * x; };
+
+    SUBCASE("results are cached by the decayed arguments")
+    {
+        const auto f = memoize(square);
+
+        CHECK(f(3) == 9);
+        CHECK(f(3) == 9);
+        CHECK(f(4) == 16);
+        CHECK(calls == 2);
+        CHECK(f.stats().hits == 1);
+        CHECK(f.stats().misses == 2);
+    }
+
+    SUBCASE("generic callables need the argument types")
+    {
+        const auto concat = memoize<std::string, std::string>([&calls](const auto& x, const auto& y) { ++calls; return x + y; });
+
+        CHECK(concat("a", "b") == "ab");
+        CHECK(concat("a"s, "b"s) == "ab");
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("works with member pointers")
+    {
+        const auto length = memoize(&Word::length);
+        CHECK(length(Word{ "abc" }) == 3);
+        CHECK(length(Word{ "abc" }) == 3);
+        CHECK(length.stats().hits == 1);
+    }
+
+    SUBCASE("copies in composed chains share the cache")
+    {
+        const auto f = memoize(square);
+        const auto g = compose(plus(1), f);
+        const auto h = curry([](int x, int y) { return x + y; })(1);
+        const auto bound = bindFront(memoize([&calls](int x, int y) { ++calls; return x - y; }), 10);
+
+        CHECK(g(5) == 26);
+        CHECK(g(5) == 26);
+        CHECK(f(5) == 25);
+        CHECK(f.stats().hits == 2);
+        CHECK(curry(f)(2) == 4);
+        CHECK(h(2) == 3);
+        CHECK(bound(3) == 7);
+        CHECK(bound(3) == 7);
+        CHECK(calls == 3);
+    }
+
+    SUBCASE("lru cache evicts the least recently used results")
+    {
+        const auto f = memoize(square, LruCache{ 2 });
+
+        f(1); f(2); f(1); f(3);
+        CHECK(calls == 3);
+        f(1);
+        CHECK(calls == 3);
+        f(2);
+        CHECK(calls == 4);
+    }
+
+    SUBCASE("direct-mapped cache keeps the last result per slot")
+    {
+        const auto f = memoize(square, DirectMappedCache{ 4 });
+
+        f(1); f(5); f(1);
+        CHECK(calls == 3);
+        f(2); f(2); f(-1);
+        CHECK(calls == 5);
+        CHECK(f(-1) == 1);
+        CHECK(calls == 5);
+    }
+
+    SUBCASE("direct-mapped cache takes bool arguments")
+    {
+        auto negations = 0;
+        const auto f = memoize([&negations](bool x) { ++negations; return !x; }, DirectMappedCache{ 2 });
+
+        CHECK(f(true) == false);
+        CHECK(f(false) == true);
+        CHECK(f(true) == false);
+        CHECK(negations == 2);
+    }
+
+    SUBCASE("sharded cache can be shared between threads")
+    {
+        auto computed = std::atomic<int>{ 0 };
+        const auto f = memoize([&computed](int x) { ++computed; return x + 1; }, ShardedCache{ 4, LruCache{ 64 } });
+        auto sums = std::vector<long>(4);
+        {
+            auto threads = std::vector<std::jthread>{};
+            for (auto t = 0; t < 4; ++t) {
+                threads.emplace_back([&f, &sum = sums[t]]
+                {
+                    for (auto i = 0; i < 1000; ++i) {
+                        sum += f(i % 100);
+                    }
+                });
+            }
+        }
+
+        CHECK(std::all_of(sums.begin(), sums.end(), equals(10 * 5050L)));
+        CHECK(f.stats().hits + f.stats().misses == 4000);
+        CHECK(computed >= 100);
+    }
+}
+
+
+TEST_CASE("tabulate")
+{
+    SUBCASE("the table is computed at compile time")
+    {
+        constexpr auto f = tabulate<0, 255>(compose(times(3), plus(1)));
+
+        static_assert(f(0) == 3);
+        static_assert(f(255) == 768);
+        static_assert(sizeof(f) == 256 * sizeof(int));
+        CHECK(f(10) == 33);
+    }
+
+    SUBCASE("negative and character domains")
+    {
+        constexpr auto square = tabulate<-3, 3>([](int x) { return x * x; });
+        constexpr auto isDigit = tabulate<'\0', '\x7f'>(allOf(greaterOrEqualTo('0'), lessOrEqualTo('9')));
+
+        static_assert(square(-3) == 9 && square(0) == 0 && square(2) == 4);
+        static_assert(isDigit('7') && !isDigit('a'));
+        CHECK(std::count_if(std::begin("a1b22"), std::end("a1b22") - 1, std::cref(isDigit)) == 3);
+    }
+
+    SUBCASE("enumeration domains")
+    {
+        enum class Color { red, green, blue };
+        constexpr auto name = tabulate<Color::red, Color::blue>(firstOf(
+            [](Color c) { return c == Color::red ? 'r' : c == Color::green ? 'g' : 'b'; }
+        ));
+
+        static_assert(name(Color::green) == 'g');
+        CHECK(name(Color::blue) == 'b');
+    }
+}
+
+
+TEST_CASE("Function")
+{
+    SUBCASE("the library's closures fit inline")
+    {
+        static_assert(fitsInline<decltype(compose(times(3), plus(1)))>);
+        static_assert(fitsInline<decltype(curry(std::plus{})(1))>);
+        static_assert(fitsInline<decltype(bindFront(std::plus{}, 1))>);
+        static_assert(fitsInline<decltype(allOf(greaterThan(0), lessThan(10)))>);
+        static_assert(fitsInline<decltype(firstOf(plus(1), identity))>);
+        static_assert(fitsInline<decltype(superpose(std::plus{}, times(2), minus(1)))>);
+        static_assert(!fitsInline<std::array<char, 128>>);
+    }
+
+    SUBCASE("stores and calls any compatible callable")
+    {
+        auto f = Function<int(int)>{ compose(times(3), plus(1)) };
+        auto g = Function<std::size_t(const Word&)>{ &Word::length };
+        auto h = Function<void(int&)>{ [](int& x) { x = 7; return x; } };
+
+        auto x = 0;
+        h(x);
+
+        CHECK(f(1) == 6);
+        CHECK(g(Word{ "abc" }) == 3);
+        CHECK(x == 7);
+        CHECK(!Function<int(int)>{});
+        CHECK(!Function<int(int)>{ static_cast<int(*)(int)>(nullptr) });
+    }
+
+    SUBCASE("is move only and moves the callable")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        auto counter = Counter{ copies, moves };
+        auto f = Function<int()>{ [counter = std::move(counter)] { return *counter.moves; } };
+        moves = 0;
+
+        auto g = std::move(f);
+        CHECK(!f);
+        CHECK(g() == 1);
+        CHECK(copies == 0);
+        static_assert(!std::is_copy_constructible_v<Function<int()>>);
+        static_assert(std::is_nothrow_move_constructible_v<Function<int()>>);
+    }
+
+    SUBCASE("owns move-only and big callables")
+    {
+        auto big = std::array<int, 64>{};
+        big[63] = 5;
+        auto p = std::make_unique<int>(3);
+        auto f = Function<int()>{ [big] { return big[63]; } };
+        auto g = Function<int()>{ [p = std::move(p)] { return *p; } };
+
+        auto table = std::vector<Function<int()>>{};
+        table.push_back(std::move(f));
+        table.push_back(std::move(g));
+        table.reserve(100);
+
+        CHECK(table[0]() == 5);
+        CHECK(table[1]() == 3);
+    }
+}
+
+TEST_CASE("FunctionRef")
+{
+    const auto apply = [](FunctionRef<int(int)> f, int x) { return f(x); };
+    const auto f = compose(times(3), plus(1));
+    auto calls = 0;
+    auto counted = [&calls](int x) { ++calls; return x; };
+
+    static_assert(sizeof(FunctionRef<int(int)>) == 2 * sizeof(void*));
+    CHECK(apply(f, 1) == 6);
+    CHECK(apply(counted, 2) == 2);
+    CHECK(calls == 1);
+    CHECK(apply(static_cast<int(*)(int)>([](int x) { return -x; }), 2) == -2);
+}
+
+
+namespace
+{
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        int allocations = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            --allocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+} //namespace
+
+TEST_CASE("allocated closures")
+{
+    const auto sum = [](const std::pmr::vector<int>& v, int x) { return std::accumulate(v.begin(), v.end(), x); };
+
+    SUBCASE("the bound state lives in the resource")
+    {
+        auto resource = CountingResource{};
+        {
+            const auto f = allocateBind(&resource, sum, std::pmr::vector<int>{ 1, 2, 3 });
+
+            static_assert(sizeof(f) == 2 * sizeof(void*));
+            CHECK(resource.allocations == 2);
+            CHECK(f(4) == 10);
+
+            const auto g = f;
+            CHECK(resource.allocations == 4);
+            CHECK(g(0) == 6);
+        }
+        CHECK(resource.allocations == 0);
+    }
+
+    SUBCASE("curried closures accumulate arguments in the resource")
+    {
+        auto resource = CountingResource{};
+        {
+            const auto add = [](int x, int y, int z) { return x + y + z; };
+            const auto f = allocateCurry(&resource, add);
+            const auto g = f(1);
+            const auto h = g(2);
+
+            CHECK(h(3) == 6);
+            CHECK(f(1, 2, 3) == 6);
+            CHECK(f(1)(2)(3) == 6);
+            CHECK(resource.allocations == 3);
+        }
+        CHECK(resource.allocations == 0);
+    }
+
+    SUBCASE("temporaries move their state to the next stage")
+    {
+        auto copies = 0;
+        auto moves = 0;
+        const auto f = allocateCurry(std::pmr::new_delete_resource(), [](const Counter&, int x, int y) { return x + y; });
+
+        CHECK(f(Counter{ copies, moves })(1)(2) == 3);
+        CHECK(copies == 0);
+    }
+
+    SUBCASE("a rule set is torn down with one arena reset")
+    {
+        auto arena = Arena{ 1024 };
+        {
+            auto rules = std::vector<decltype(allocateBind(&arena, sum, std::pmr::vector<int>{}))>{};
+            for (auto i = 0; i < 100; ++i) {
+                rules.push_back(allocateBind(&arena, sum, std::pmr::vector<int>(i, 1)));
+            }
+            CHECK(rules[99](1) == 100);
+        }
+        arena.reset();
+    }
+}
+
+
+TEST_CASE("match")
+{
+    struct Login { std::string user; };
+    struct Logout { };
+    struct Ping { int id; };
+    using Message = std::variant<Login, Logout, Ping>;
+
+    const auto describe = firstOf(
+        [](const Login& m) { return "login " + m.user; },
+        [](const Ping& m) { return "ping " + std::to_string(m.id); },
+        [](const auto&) { return "other"s; }
+    );
+
+    SUBCASE("calls the overload handling the active alternative")
+    {
+        CHECK(match(Message{ Login{ "root" } }, describe) == "login root");
+        CHECK(match(Message{ Ping{ 7 } }, describe) == "ping 7");
+        CHECK(match(Message{ Logout{} }, describe) == "other");
+    }
+
+    SUBCASE("alternatives are passed with the value category of the variant")
+    {
+        auto message = Message{ Ping{ 1 } };
+        match(message, firstOf([](Ping& p) { p.id = 2; }, [](auto&) { }));
+        CHECK(std::get<Ping>(message).id == 2);
+
+        const auto moved = match(Message{ Login{ "x" } }, firstOf([](Login&& m) { return std::move(m.user); }, [](auto&&) { return ""s; }));
+        CHECK(moved == "x");
+    }
+
+    SUBCASE("works at compile time")
+    {
+        constexpr auto v = std::variant<int, Logout>{ Logout{} };
+        static_assert(match(v, firstOf([](int) { return 1; }, [](Logout) { return 2; })) == 2);
+    }
+
+    SUBCASE("deleted entries are detected before dispatching")
+    {
+        using F = decltype(firstOf(Deleted([](const Logout&) { return 0; }), [](const auto&) { return 1; }));
+
+        static_assert(F::isDeleted<const Logout&>());
+        static_assert(!F::isDeleted<const Ping&>());
+    }
+
+    SUBCASE("visitFirstOf falls back to std::visit for several variants")
+    {
+        const auto v = std::variant<int, double>{ 2 };
+        const auto w = std::variant<int, double>{ 0.5 };
+        const auto sum = [](auto x, auto y) { return static_cast<double>(x + y); };
+
+        CHECK(visitFirstOf(sum, v, w) == 2.5);
+        CHECK(visitFirstOf(describe, Message{ Ping{ 3 } }) == "ping 3");
+    }
+}
+
+TEST_CASE("dispatch on keys")
+{
+    struct Route
+    {
+        int id() const { return code; }
+        int code;
+        std::string path;
+    };
+
+    SUBCASE("matchesAny with a fixed set of keys")
+    {
+        constexpr auto isReserved = matchesAny({ 443, 22, 80, 8080 }, identity);
+        static_assert(isReserved(80));
+        static_assert(!isReserved(81));
+
+        const auto reservedRoute = matchesAny(std::array{ 443, 22 }, &Route::id);
+        CHECK(reservedRoute(Route{ 22, "/ssh" }));
+        CHECK(!reservedRoute(Route{ 25, "/mail" }));
+    }
+
+    SUBCASE("matchesAny with keys known at runtime")
+    {
+        const auto paths = std::vector<std::string>{ "/b", "/c", "/a" };
+        const auto isKnown = matchesAny(paths, &Route::path);
+
+        CHECK(isKnown(Route{ 1, "/a" }));
+        CHECK(isKnown(Route{ 1, "/c" }));
+        CHECK(!isKnown(Route{ 1, "/d" }));
+    }
+
+    SUBCASE("string literals are compared by contents")
+    {
+        const auto isVerb = matchesAny({ "get", "put", "post" }, [](const std::string& s) { return std::string_view{ s }; });
+
+        CHECK(isVerb("post"s));
+        CHECK(!isVerb("patch"s));
+    }
+
+    SUBCASE("dispatchOn calls the handler of the extracted key")
+    {
+        const auto handle = dispatchOn(&Route::id,
+                                       onKey(200, [](const Route& r) { return "ok " + r.path; }),
+                                       onKey(404, [](const Route&) { return "missing"s; }),
+                                       onKey(200, [](const Route&) { return "shadowed"s; }));
+
+        CHECK(handle(Route{ 200, "/" }) == "ok /");
+        CHECK(handle(Route{ 404, "/x" }) == "missing");
+        CHECK(handle(Route{ 500, "/" }) == std::nullopt);
+    }
+
+    SUBCASE("results returned by reference are copied")
+    {
+        auto routes = std::vector<Route>{ { 200, "/" }, { 404, "/x" } };
+        const auto handle = dispatchOn(&Route::id,
+                                       onKey(200, [&routes](const Route&) -> std::string& { return routes[0].path; }),
+                                       onKey(404, [&routes](const Route&) -> const std::string& { return routes[1].path; }));
+
+        auto result = handle(Route{ 200, "" });
+        static_assert(std::is_same_v<decltype(result), std::optional<std::string>>);
+        *result = "/changed";
+
+        CHECK(routes[0].path == "/");
+        CHECK(handle(Route{ 404, "" }) == "/x");
+    }
+
+    SUBCASE("void handlers report whether a key was handled")
+    {
+        auto count = 0;
+        const auto handle = dispatchOn([](int x) { return x % 3; },
+                                       onKey(0, [&count](int) { ++count; }),
+                                       onKey(1, [&count](int x) { count += x; }));
+
+        CHECK(handle(3));
+        CHECK(handle(4));
+        CHECK(!handle(5));
+        CHECK(count == 5);
+    }
+
+    SUBCASE("dispatchOn works at compile time")
+    {
+        constexpr auto classify = dispatchOn(identity,
+                                             onKey('b', [](char) { return 2; }),
+                                             onKey('a', [](char) { return 1; }));
+        static_assert(classify('a') == 1);
+        static_assert(classify('b') == 2);
+        static_assert(!classify('c'));
+    }
+}
+
+TEST_CASE("instrumentation")
+{
+    SUBCASE("instrumented functions give the results of the originals")
+    {
+        const auto square = instrument("square", [](int x) noexcept { return x * x; });
+        const auto first = instrument("first", [](std::vector<int>& v) -> int& { return v.front(); });
+        auto v = std::vector<int>{ 1, 2 };
+
+        CHECK(square(3) == 9);
+        static_assert(noexcept(square(3)));
+        static_assert(std::is_same_v<decltype(first(v)), int&>);
+        first(v) = 5;
+        CHECK(v.front() == 5);
+    }
+
+    SUBCASE("calls, latencies and exceptions are recorded")
+    {
+        const auto parse = instrument("parse", [](const std::string& s) { return std::stoi(s); });
+
+        parse("1"s);
+        parse("2"s);
+        CHECK_THROWS(parse("x"s));
+
+        const auto stats = parse.stats();
+        CHECK(stats.name == "parse");
+        CHECK(stats.calls == 3);
+        CHECK(stats.exceptions == 1);
+        CHECK(std::accumulate(std::begin(stats.latencies), std::end(stats.latencies), std::uint64_t{ 0 }) == 3);
+    }
+
+    SUBCASE("calls from different threads are aggregated")
+    {
+        const auto f = instrument("threaded", [](int x) { return x + 1; });
+        {
+            auto threads = std::vector<std::jthread>{};
+            for (auto i = 0; i < 4; ++i) {
+                threads.emplace_back([f] { for (auto j = 0; j < 100; ++j) { f(j); } });
+            }
+        }
+        CHECK(f.stats().calls == 400);
+    }
+
+    SUBCASE("instrumentStages records each function of a composition")
+    {
+        const auto f = instrumentStages("pipeline", compose([](int x) { return x * 2; }, plus(1)));
+
+        CHECK(f(1) == 4);
+        CHECK(f(2) == 6);
+
+        const auto report = instrumentationReport();
+        const auto calls = [&report](const std::string& name)
+        {
+            const auto pos = std::find_if(std::begin(report), std::end(report), [&name](const auto& s) { return s.name == name; });
+            return pos != std::end(report) ? pos->calls : 0;
+        };
+        CHECK(calls("pipeline") == 2);
+        CHECK(calls("pipeline/0") == 2);
+        CHECK(calls("pipeline/1") == 2);
+    }
+
+    SUBCASE("instrumentStages records each function of a superposition")
+    {
+        const auto sum = [](int x, int y) { return x + y; };
+        const auto f = instrumentStages("superposition", superpose(sum, plus(1), times(2)));
+        const auto g = instrumentStages("moving superposition", superpose(lastUseMoves, sum, plus(1), times(2)));
+
+        CHECK(f(1) == 4);
+        CHECK(f(2) == 7);
+        CHECK(g(3) == 10);
+
+        const auto report = instrumentationReport();
+        const auto calls = [&report](const std::string& name)
+        {
+            const auto pos = std::find_if(std::begin(report), std::end(report), [&name](const auto& s) { return s.name == name; });
+            return pos != std::end(report) ? pos->calls : 0;
+        };
+        CHECK(calls("superposition") == 2);
+        CHECK(calls("superposition/0") == 2);
+        CHECK(calls("superposition/1") == 2);
+        CHECK(calls("superposition/2") == 2);
+        CHECK(calls("moving superposition/0") == 1);
+        CHECK(calls("moving superposition/2") == 1);
+    }
+}
+
+TEST_CASE("simplify")
+{
+    SUBCASE("identities are dropped and nested compositions flattened")
+    {
+        const auto toString = [](int x) { return std::to_string(x); };
+        const auto f = simplify(compose(toString, identity, compose(identity, std::negate{})));
+
+        static_assert(std::is_same_v<decltype(f), const Detail::Composed<std::remove_const_t<decltype(toString)>, std::negate<>>>);
+        CHECK(f(2) == "-2");
+        static_assert(std::is_same_v<decltype(simplify(compose(identity, identity))), std::remove_const_t<decltype(identity)>>);
+    }
+
+    SUBCASE("consecutive integral sections are fused")
+    {
+        constexpr auto f = simplify(compose(plus(1), plus(2), times(3), times(4)));
+
+        static_assert(f(1) == 15);
+        static_assert(std::tuple_size_v<std::remove_cvref_t<decltype(f.functions())>> == 2);
+    }
+
+    SUBCASE("fused sections keep the results of the chain for other argument types")
+    {
+        constexpr auto f = simplify(compose(plus(1), plus(2)));
+        static_assert(f(0.5) == 3.5);
+        static_assert(f(std::numeric_limits<long long>::max() - 3) == std::numeric_limits<long long>::max());
+
+        const auto grow = simplify(compose(times(-2), times(3)));
+        CHECK(grow(-7) == 42);
+        CHECK(grow(3u) == compose(times(-2), times(3))(3u));
+    }
+
+    SUBCASE("only the fused call of the operand type is noexcept")
+    {
+        const auto f = simplify(compose(plus(1), plus(2)));
+
+        static_assert(noexcept(f(1)));
+        static_assert(!noexcept(f(Money{ 1 })));
+        CHECK(f(Money{ 1 }).cents == 4);
+        CHECK_THROWS_AS(f(Money{ std::numeric_limits<int>::max() - 2 }), std::overflow_error);
+    }
+
+    SUBCASE("sections over floating point types are not fused")
+    {
+        const auto f = simplify(compose(plus(0.1), plus(0.2)));
+        static_assert(std::is_same_v<decltype(f), const decltype(compose(plus(0.1), plus(0.2)))>);
+    }
+
+    SUBCASE("double inverses and double flips are dropped")
+    {
+        constexpr auto isBig = greaterThan(10);
+
+        static_assert(std::is_same_v<decltype(simplify(inverse(inverse(isBig)))), std::remove_const_t<decltype(isBig)>>);
+        static_assert(simplify(inverse(inverse(inverse(isBig))))(5));
+        static_assert(simplify(flip(flip(std::minus{})))(3, 1) == 2);
+        static_assert(std::is_same_v<decltype(simplify(flip(flip(std::minus{})))), std::minus<>>);
+    }
+}
+
+TEST_CASE("placeholder expressions")
+{
+    using namespace Placeholders;
+
+    SUBCASE("expressions combine placeholders and constants")
+    {
+        constexpr auto f = _1 * 5 + _2;
+        constexpr auto inRange = _1 >= 0 && _1 < 10;
+
+        static_assert(f(2, 3) == 13);
+        static_assert(inRange(3) && !inRange(10));
+        static_assert((-_1)(3) == -3);
+        static_assert((!(_1 == _2))(1, 2));
+        CHECK((_1 + "!"s)("hi"s) == "hi!");
+    }
+
+    SUBCASE("expressions of placeholders only take no space")
+    {
+        static_assert(sizeof(_1 + _2) == 1);
+        static_assert(sizeof(_1 * 5 + _2) == sizeof(int));
+    }
+
+    SUBCASE("arguments are passed by reference")
+    {
+        auto x = std::string{ "abc" };
+        static_assert(std::is_same_v<decltype(_1(x)), std::string&>);
+        CHECK(&_2(0, x) == &x);
+    }
+
+    SUBCASE("apply and mask work over whole ranges")
+    {
+        auto in = std::vector<float>(103);
+        std::iota(in.begin(), in.end(), 0.0f);
+        auto out = std::vector<float>(in.size());
+
+        (_1 * 2.0f + 1.0f).apply(std::span<const float>{ in }, std::span{ out });
+        const auto mask = (_1 > 10.0f && _1 < 20.0f).mask(in);
+
+        for (auto i = std::size_t{ 0 }; i < in.size(); ++i) {
+            CHECK(out[i] == 2 * in[i] + 1);
+            CHECK(mask[i] == (in[i] > 10 && in[i] < 20));
+        }
+        CHECK(mask.count() == 9);
+    }
+
+    SUBCASE("mutable spans are accepted as inputs")
+    {
+        auto nums = std::vector<int>{ 1, 2, 3, 4 };
+        auto out = std::vector<int>(nums.size());
+
+        (_1 * 2 + 1).apply(std::span{ nums }, out);
+
+        CHECK(out == std::vector<int>{ 3, 5, 7, 9 });
+        CHECK((_1 > 2).mask(std::span{ nums }).selection() == std::vector<std::size_t>{ 2, 3 });
+    }
+
+    SUBCASE("expressions work as predicates of the other utilities")
+    {
+        const auto nums = std::vector<int>{ 1, -2, 3, -4 };
+        CHECK(std::count_if(std::begin(nums), std::end(nums), _1 < 0) == 2);
+        CHECK(compose(_1 * 2, plus(1))(1) == 4);
+    }
+}
+
+TEST_CASE("columns")
+{
+    struct Person
+    {
+        int id;
+        double score;
+        int age() const noexcept { return id * 2; }
+    };
+
+    auto people = std::vector<Person>{ { 1, 0.5 }, { 2, 1.5 }, { 3, 2.5 }, { 2, 3.5 } };
+    auto pointers = std::vector<const Person*>{};
+    for (const auto& person : people) {
+        pointers.push_back(&person);
+    }
+
+    SUBCASE("matches runs over the column of its projection")
+    {
+        const auto table = columns(pointers, &Person::id, &Person::score);
+
+        CHECK(table.size() == 4);
+        CHECK(table.select(matches(2, &Person::id)) == std::vector<std::size_t>{ 1, 3 });
+        CHECK(table.find(matches(3, &Person::id)) == 2);
+        CHECK(table.find(matches(7, &Person::id)) == table.size());
+        CHECK(*table.find(pointers, matches(2, &Person::id)) == &people[1]);
+        CHECK(table.mask(compose(greaterThan(1.0), &Person::score)).count() == 3);
+        CHECK(table.mask(&Person::score, lessThan(2.0)).selection() == std::vector<std::size_t>{ 0, 1 });
+        CHECK(table.column(&Person::id)[2] == 3);
+    }
+
+    SUBCASE("records may be objects and projections member functions")
+    {
+        const auto table = columns(people, &Person::age);
+
+        CHECK(table.select(matches(4, &Person::age)) == std::vector<std::size_t>{ 1, 3 });
+        CHECK(table.select(compose(lessThan(4), plus(-1), &Person::age)) == std::vector<std::size_t>{ 0, 1, 3 });
+    }
+
+    SUBCASE("columns follow the changes they are told about")
+    {
+        auto table = columns(pointers, &Person::id);
+
+        people[0].id = 2;
+        CHECK(table.select(matches(2, &Person::id)).size() == 2);
+        table.update(0, &people[0]);
+        CHECK(table.select(matches(2, &Person::id)).size() == 3);
+
+        const auto extra = Person{ 2, 0.0 };
+        table.pushBack(&extra);
+        CHECK(table.select(matches(2, &Person::id)) == std::vector<std::size_t>{ 0, 1, 3, 4 });
+    }
+
+    SUBCASE("scans cross the blocks")
+    {
+        auto many = std::vector<Person>(10000, Person{ 0, 0.0 });
+        many[9000].id = 1;
+        const auto table = columns(many, &Person::id);
+
+        CHECK(table.find(matches(1, &Person::id)) == 9000);
+        CHECK(table.mask(matches(0, &Person::id)).count() == 9999);
+    }
+
+    SUBCASE("projections which are not columns are rejected")
+    {
+        const auto table = columns(people, &Person::id);
+
+        CHECK_THROWS_AS(table.column(&Person::score), std::invalid_argument);
+    }
+}
+
+TEST_CASE("fixed points and trampolines")
+{
+    SUBCASE("fix lets lambdas recurse")
+    {
+        constexpr auto factorial = fix([](const auto& self, int n) -> int { return n <= 1 ? 1 : n * self(n - 1); });
+        const auto fib = fix([](const auto& self, int n) -> int { return n < 2 ? n : self(n - 1) + self(n - 2); });
+
+        static_assert(factorial(5) == 120);
+        CHECK(fib(20) == 6765);
+        CHECK((invoke)(factorial, 4) == 24);
+        CHECK(compose(plus(1), factorial)(3) == 7);
+    }
+
+    SUBCASE("trampolines run in constant stack")
+    {
+        const auto sum = trampoline([](long long n, long long acc) -> Step<long long, long long, long long>
+        {
+            if (n == 0) {
+                return Done{ acc };
+            }
+            return Continue{ n - 1, acc + n };
+        });
+
+        CHECK(sum(10'000'000LL, 0LL) == 50'000'005'000'000LL);
+        CHECK(sum(3, 0) == 6);
+        CHECK(compose(times(2), sum)(4, 0) == 20);
+    }
+
+    SUBCASE("trampolines are constexpr")
+    {
+        constexpr auto gcd = trampoline([](unsigned a, unsigned b) -> Step<unsigned, unsigned, unsigned>
+        {
+            if (b == 0) {
+                return Done{ a };
+            }
+            return Continue{ b, a % b };
+        });
+
+        static_assert(gcd(12u, 18u) == 6);
+        static_assert(gcd(7u, 0u) == 7);
+    }
+
+    SUBCASE("the state is moved from step to step")
+    {
+        const auto join = trampoline([](std::vector<int> xs, int n) -> Step<std::vector<int>, std::vector<int>, int>
+        {
+            if (n == 0) {
+                return Done{ std::move(xs) };
+            }
+            xs.push_back(n);
+            return Continue{ std::move(xs), n - 1 };
+        });
+
+        CHECK(join(std::vector<int>{}, 3) == std::vector<int>{ 3, 2, 1 });
+    }
+}
+
+namespace
+{
+    class TemporaryFile
+    {
+    public:
+        explicit TemporaryFile(const std::string& contents)
+            : path(std::filesystem::temp_directory_path() / ("functional-" + std::to_string(::getpid()) + "-" + std::to_string(counter++)))
+        {
+            std::ofstream{ path, std::ios::binary } << contents;
+        }
+
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        ~TemporaryFile() { std::filesystem::remove(path); }
+
+        std::string name() const { return path.string(); }
+
+    private:
+        static inline auto counter = 0;
+
+        std::filesystem::path path;
+    };
+} //namespace
+
+TEST_CASE("input sources")
+{
+    SUBCASE("mmapSource yields views of the records of a mapped file")
+    {
+        const auto file = TemporaryFile{ "1,a\n22,b\n3,c" };
+
+        //the views are valid as long as the generator
+        auto records = mmapSource(file.name(), lines);
+        auto result = std::vector<std::string_view>{};
+        for (auto line : records) {
+            result.push_back(line);
+        }
+        CHECK(result == std::vector<std::string_view>{ "1,a", "22,b", "3,c" });
+    }
+
+    SUBCASE("records feed the pipelines")
+    {
+        auto contents = std::string{};
+        for (auto i = 0; i < 20000; ++i) {
+            contents += std::to_string(i % 10) + "\n";
+        }
+        const auto file = TemporaryFile{ contents };
+
+        const auto front = [](std::string_view line) { return line.front(); };
+        const auto length = [](std::string_view line) { return line.size(); };
+        //a window of a byte advises and releases between almost every record
+        const auto sevens = mmapSource(file.name(), lines, 1) | filter(matches('7', front)) | map(length) | fold(std::plus{}, std::size_t{ 0 });
+        CHECK(sevens == 2000);
+    }
+
+    SUBCASE("parsers choose the records")
+    {
+        const auto file = TemporaryFile{ "abcdefgh" };
+        const auto pairs = [](std::string_view rest) { return std::pair{ rest.substr(0, 2), std::size_t{ 2 } }; };
+
+        auto result = std::string{};
+        for (auto pair : mmapSource(file.name(), pairs)) {
+            result += pair.back();
+        }
+        CHECK(result == "bdfh");
+    }
+
+    SUBCASE("empty and missing files")
+    {
+        const auto file = TemporaryFile{ "" };
+
+        CHECK((mmapSource(file.name(), lines) | fold([](int n, auto) { return n + 1; }, 0)) == 0);
+        CHECK_THROWS_AS(mmapSource(file.name() + ".missing", lines), std::system_error);
+    }
+
+    SUBCASE("chunkedReader reads a descriptor in chunks")
+    {
+        const auto file = TemporaryFile{ "0123456789" };
+        const auto fd = ::open(file.name().c_str(), O_RDONLY);
+        REQUIRE(fd >= 0);
+
+        auto sizes = std::vector<std::size_t>{};
+        auto result = std::string{};
+        for (auto chunk : chunkedReader(fd, 4)) {
+            sizes.push_back(chunk.size());
+            result.append(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+        }
+        ::close(fd);
+
+        CHECK(sizes == std::vector<std::size_t>{ 4, 4, 2 });
+        CHECK(result == "0123456789");
+    }
+
+    SUBCASE("read errors reach the consumer")
+    {
+        auto g = chunkedReader(-1, 16);
+        CHECK_THROWS_AS(g.begin(), std::system_error);
+    }
+}
+
+TEST_CASE("batched")
+{
+    using namespace std::chrono_literals;
+
+    SUBCASE("calls from many threads are batched together")
+    {
+        constexpr auto threadCount = 8;
+        constexpr auto callsPerThread = 50;
+
+        auto batches = std::atomic<int>{ 0 };
+        auto smallest = std::atomic<std::size_t>{ threadCount };
+        //each thread waits for its call, so a batch of threadCount takes a call of every thread
+        //and the deadline, far longer than the test, is never reached
+        const auto square = batched([&](std::span<const int> xs)
+        {
+            ++batches;
+            for (auto size = smallest.load(); xs.size() < size && !smallest.compare_exchange_weak(size, xs.size()); ) { }
+            auto result = std::vector<long>{};
+            for (auto x : xs) {
+                result.push_back(long{ x } * x);
+            }
+            return result;
+        }, threadCount, 1h);
+
+        auto sums = std::vector<long>(threadCount);
+        {
+            auto threads = std::vector<std::jthread>{};
+            for (auto t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&, t]
+                {
+                    for (auto i = 0; i < callsPerThread; ++i) {
+                        sums[t] += square(i);
+                    }
+                });
+            }
+        }
+
+        const auto expected = long{ callsPerThread - 1 } * callsPerThread * (2 * callsPerThread - 1) / 6;
+        CHECK(std::all_of(std::begin(sums), std::end(sums), equals(expected)));
+        CHECK(batches == callsPerThread);
+        CHECK(smallest == threadCount);
+    }
+
+    SUBCASE("futures are completed by full batches and by the destruction of the batcher")
+    {
+        auto sizes = std::vector<std::size_t>{};
+        auto futures = std::vector<std::future<int>>{};
+        {
+            //the deadline is far longer than the test, so only full batches are processed before the destruction
+            const auto negate = batched<int>([&sizes](std::span<const int> xs)
+            {
+                sizes.push_back(xs.size());
+                auto result = std::vector<int>{};
+                for (auto x : xs) {
+                    result.push_back(-x);
+                }
+                return result;
+            }, 3, 1h);
+
+            for (auto i = 0; i < 4; ++i) {
+                futures.push_back(negate.submit(i));
+            }
+            CHECK(futures[0].wait_for(0s) == std::future_status::ready);
+            CHECK(futures[3].wait_for(0s) == std::future_status::timeout);
+        }
+        for (auto i = 0; i < 4; ++i) {
+            CHECK(futures[i].get() == -i);
+        }
+        CHECK(sizes == std::vector<std::size_t>{ 3, 1 });
+    }
+
+    SUBCASE("an incomplete batch is processed by its deadline")
+    {
+        const auto negate = batched<int>([](std::span<const int> xs)
+        {
+            auto result = std::vector<int>{};
+            for (auto x : xs) {
+                result.push_back(-x);
+            }
+            return result;
+        }, 3, 1ms);
+
+        CHECK(negate(2) == -2);
+    }
+
+    SUBCASE("batched functions compose")
+    {
+        const auto length = batched([](std::span<const std::string> xs)
+        {
+            auto result = std::vector<std::size_t>{};
+            for (const auto& x : xs) {
+                result.push_back(x.size());
+            }
+            return result;
+        }, 8, 100us);
+
+        CHECK(compose(times(2u), length)("abc"s) == 6);
+    }
+
+    SUBCASE("failures reach every caller of the batch")
+    {
+        const auto failing = batched<int>([](std::span<const int>) -> std::vector<int> { throw std::runtime_error{ "failed" }; }, 2, 1ms);
+        const auto incomplete = batched<int>([](std::span<const int>) { return std::vector<int>{}; }, 1, 1ms);
+
+        auto first = failing.submit(1);
+        auto second = failing.submit(2);
+        CHECK_THROWS_AS(first.get(), std::runtime_error);
+        CHECK_THROWS_AS(second.get(), std::runtime_error);
+        CHECK_THROWS_AS(incomplete(1), std::length_error);
+    }
+
+//set_value runs under call_once, which the ThreadSanitizer runtime leaves locked when it throws
+#if !defined(__SANITIZE_THREAD__)
+    SUBCASE("a failure after some results were handed out reaches only the rest")
+    {
+        struct Checked
+        {
+            Checked(int value) : value(value) { }
+            Checked(const Checked&) = default;
+            Checked(Checked&& source) : value(source.value)
+            {
+                if (value < 0) {
+                    throw std::range_error{ "negative" };
+                }
+            }
+
+            int value;
+        };
+
+        const auto check = batched<int>([](std::span<const int> xs)
+        {
+            auto result = std::vector<Checked>{};
+            for (auto x : xs) {
+                result.emplace_back(x);
+            }
+            return result;
+        }, 3, 1h);
+
+        auto first = check.submit(1);
+        auto second = check.submit(-2);
+        auto third = check.submit(3);
+        CHECK(first.get().value == 1);
+        CHECK_THROWS_AS(second.get(), std::range_error);
+        CHECK_THROWS_AS(third.get(), std::range_error);
+    }
+#endif
+}
@@ -0,0 +1,289 @@
+//Compares the public combinators against the equivalent hand-written lambdas.
+//
+//  g++ -std=c++20 -O2 -I. tests/runtimeBenchmark.cpp -lbenchmark -lpthread -o runtimeBenchmark
+//  ./runtimeBenchmark [--max_overhead=0.05] [--benchmark_filter=...]
+//
+//Every combinator is measured next to a lambda doing the same work on the same data.
+//A combinator which is slower than its lambda by more than the allowed overhead is reported
+//and the program exits with a non-zero status. Since the lambdas are written so that the
+//compiler can vectorize them, a combinator that blocks auto-vectorization shows up as
+//a several-fold slowdown and fails the check as well.
+
+#include "include/functional.hpp"
+#include "include/fix.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace IDragnev::Functional;
+using namespace std::string_literals;
+
+namespace
+{
+    const auto numericSizes = std::vector<std::int64_t>{ 1'000'000, 10'000'000, 100'000'000 };
+    const auto stringSizes = std::vector<std::int64_t>{ 1'000'000, 10'000'000 };
+
+    struct Person
+    {
+        unsigned id;
+        double score;
+    };
+
+    template <typename T>
+    const std::vector<T>& data(std::size_t size);
+
+    template <>
+    const std::vector<int>& data<int>(std::size_t size)
+    {
+        static auto cache = std::map<std::size_t, std::vector<int>>{};
+        auto& result = cache[size];
+        if (result.empty()) {
+            auto engine = std::mt19937{ 42 };
+            auto distribution = std::uniform_int_distribution<int>{ -1000, 1000 };
+            result.resize(size);
+            std::generate(result.begin(), result.end(), [&] { return distribution(engine); });
+        }
+        return result;
+    }
+
+    template <>
+    const std::vector<double>& data<double>(std::size_t size)
+    {
+        static auto cache = std::map<std::size_t, std::vector<double>>{};
+        auto& result = cache[size];
+        if (result.empty()) {
+            const auto& ints = data<int>(size);
+            result.assign(ints.begin(), ints.end());
+            std::transform(result.begin(), result.end(), result.begin(), [](double x) { return x / 7.0; });
+        }
+        return result;
+    }
+
+    template <>
+    const std::vector<std::string>& data<std::string>(std::size_t size)
+    {
+        static auto cache = std::map<std::size_t, std::vector<std::string>>{};
+        auto& result = cache[size];
+        if (result.empty()) {
+            const auto& ints = data<int>(size);
+            result.reserve(size);
+            std::transform(ints.begin(), ints.end(), std::back_inserter(result), [](int x) { return "key" + std::to_string(x % 64); });
+        }
+        return result;
+    }
+
+    template <>
+    const std::vector<Person>& data<Person>(std::size_t size)
+    {
+        static auto cache = std::map<std::size_t, std::vector<Person>>{};
+        auto& result = cache[size];
+        if (result.empty()) {
+            result.reserve(size);
+            for (auto i = 0u; i < size; ++i) {
+                result.push_back(Person{ i, i / 3.0 });
+            }
+        }
+        return result;
+    }
+
+    template <typename T, typename F>
+    void transformed(benchmark::State& state, F f)
+    {
+        const auto& in = data<T>(state.range(0));
+        auto out = std::vector<std::decay_t<std::invoke_result_t<F, const T&>>>(in.size());
+        for (auto _ : state) {
+            std::transform(in.begin(), in.end(), out.begin(), f);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * in.size());
+    }
+
+    template <typename T, typename F>
+    void transformedPairwise(benchmark::State& state, F f)
+    {
+        const auto& in = data<T>(state.range(0));
+        auto out = std::vector<T>(in.size());
+        for (auto _ : state) {
+            std::transform(in.begin(), in.end(), in.rbegin(), out.begin(), f);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * in.size());
+    }
+
+    template <typename T, typename P>
+    void counted(benchmark::State& state, P p)
+    {
+        const auto& in = data<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::count_if(in.begin(), in.end(), p));
+        }
+        state.SetItemsProcessed(state.iterations() * in.size());
+    }
+
+    template <typename T, typename P>
+    void found(benchmark::State& state, P p)
+    {
+        const auto& in = data<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::find_if(in.begin(), in.end(), p));
+        }
+        state.SetItemsProcessed(state.iterations() * in.size());
+    }
+
+    template <typename Run, typename Combinator, typename Lambda>
+    void registerPair(const std::string& name, Run run, Combinator combinator, Lambda lambda, const std::vector<std::int64_t>& sizes)
+    {
+        auto* c = benchmark::RegisterBenchmark((name + "/combinator").c_str(), [=](benchmark::State& state) { run(state, combinator); });
+        auto* l = benchmark::RegisterBenchmark((name + "/lambda").c_str(), [=](benchmark::State& state) { run(state, lambda); });
+        for (auto size : sizes) {
+            c->Arg(size);
+            l->Arg(size);
+        }
+        c->Unit(benchmark::kMillisecond);
+        l->Unit(benchmark::kMillisecond);
+    }
+
+    template <typename T>
+    void registerNumeric(const std::string& type)
+    {
+        const auto transform = [](benchmark::State& state, auto f) { transformed<T>(state, f); };
+        const auto transformPairwise = [](benchmark::State& state, auto f) { transformedPairwise<T>(state, f); };
+        const auto count = [](benchmark::State& state, auto p) { counted<T>(state, p); };
+        const auto k = T{ 3 };
+        const auto& sizes = numericSizes;
+
+        registerPair("plus<" + type + ">", transform, plus(k), [k](T x) { return x + k; }, sizes);
+        registerPair("minus<" + type + ">", transform, minus(k), [k](T x) { return x - k; }, sizes);
+        registerPair("times<" + type + ">", transform, times(k), [k](T x) { return x * k; }, sizes);
+        registerPair("divided<" + type + ">", transform, divided(k), [k](T x) { return x / k; }, sizes);
+        if constexpr (std::is_integral_v<T>) {
+            registerPair("mod<" + type + ">", transform, mod(k), [k](T x) { return x % k; }, sizes);
+            const auto bits = trampoline([](T x, T acc) -> Step<T, T, T> { return x == 0 ? Step<T, T, T>{ Done{ acc } } : Continue{ T(x / 2), T(acc + (x & 1)) }; });
+            const auto trampolined = [bits](T x) { return bits(x, T{ 0 }); };
+            registerPair("trampoline<" + type + ">", transform, trampolined, [](T x) { auto acc = T{ 0 }; for (; x != 0; x /= 2) { acc += x & 1; } return acc; }, sizes);
+        }
+        registerPair("identity<" + type + ">", transform, identity, [](T x) { return x; }, sizes);
+        registerPair("compose<" + type + ">", transform, compose(times(k), plus(k), minus(k)), [k](T x) { return ((x - k) + k) * k; }, sizes);
+        registerPair("superpose<" + type + ">", transform, superpose(std::plus{}, times(k), minus(k)), [k](T x) { return x * k + (x - k); }, sizes);
+        registerPair("curry<" + type + ">", transform, curry(std::multiplies{})(k), [k](T x) { return k * x; }, sizes);
+        registerPair("bindFront<" + type + ">", transform, bindFront(std::multiplies{}, k), [k](T x) { return k * x; }, sizes);
+        registerPair("flip<" + type + ">", transformPairwise, flip(std::minus{}), [](T x, T y) { return y - x; }, sizes);
+        registerPair("firstOf<" + type + ">", transform, firstOf([k](T x) { return x * k; }, identity), [k](T x) { return x * k; }, sizes);
+
+        registerPair("equals<" + type + ">", count, equals(k), [k](T x) { return x == k; }, sizes);
+        registerPair("differs<" + type + ">", count, differs(k), [k](T x) { return x != k; }, sizes);
+        registerPair("lessThan<" + type + ">", count, lessThan(k), [k](T x) { return x < k; }, sizes);
+        registerPair("greaterThan<" + type + ">", count, greaterThan(k), [k](T x) { return x > k; }, sizes);
+        registerPair("lessOrEqualTo<" + type + ">", count, lessOrEqualTo(k), [k](T x) { return x <= k; }, sizes);
+        registerPair("greaterOrEqualTo<" + type + ">", count, greaterOrEqualTo(k), [k](T x) { return x >= k; }, sizes);
+        registerPair("inverse<" + type + ">", count, inverse(lessThan(k)), [k](T x) { return !(x < k); }, sizes);
+        registerPair("allOf<" + type + ">", count, allOf(greaterThan(-k), lessThan(k)), [k](T x) { return x > -k && x < k; }, sizes);
+        registerPair("anyOf<" + type + ">", count, anyOf(lessThan(-k), greaterThan(k)), [k](T x) { return x < -k || x > k; }, sizes);
+        registerPair("noneOf<" + type + ">", count, noneOf(lessThan(-k), greaterThan(k)), [k](T x) { return !(x < -k || x > k); }, sizes);
+        registerPair("allOf(blockwise)<" + type + ">", count, allOf(blockwise, greaterThan(-k), lessThan(k)), [k](T x) { return (x > -k) & (x < k); }, sizes);
+        registerPair("anyOf(blockwise)<" + type + ">", count, anyOf(blockwise, lessThan(-k), greaterThan(k)), [k](T x) { return (x < -k) | (x > k); }, sizes);
+    }
+
+    void registerStrings()
+    {
+        using T = std::string;
+        const auto count = [](benchmark::State& state, auto p) { counted<T>(state, p); };
+        const auto transform = [](benchmark::State& state, auto f) { transformed<T>(state, f); };
+        const auto key = "key7"s;
+        const auto& sizes = stringSizes;
+
+        registerPair("equals<string>", count, equals(key), [key](const T& x) { return x == key; }, sizes);
+        registerPair("differs<string>", count, differs(key), [key](const T& x) { return x != key; }, sizes);
+        registerPair("lessThan<string>", count, lessThan(key), [key](const T& x) { return x < key; }, sizes);
+        registerPair("allOf<string>", count, allOf(greaterThan("key1"s), lessThan(key)), [key](const T& x) { return x > "key1"s && x < key; }, sizes);
+        registerPair("plus<string>", transform, plus("!"s), [](const T& x) { return x + "!"s; }, sizes);
+    }
+
+    void registerRecords()
+    {
+        using T = Person;
+        const auto find = [](benchmark::State& state, auto p) { found<T>(state, p); };
+        const auto count = [](benchmark::State& state, auto p) { counted<T>(state, p); };
+        const auto& sizes = numericSizes;
+
+        registerPair("matches<Person>", find, matches(999'999u, &Person::id), [](const Person& p) { return p.id == 999'999u; }, sizes);
+        registerPair("composeProjection<Person>", count, compose(lessThan(100.0), &Person::score), [](const Person& p) { return p.score < 100.0; }, sizes);
+    }
+
+    class OverheadReporter : public benchmark::ConsoleReporter
+    {
+    public:
+        void ReportRuns(const std::vector<Run>& runs) override
+        {
+            ConsoleReporter::ReportRuns(runs);
+            for (const auto& run : runs) {
+                if (run.run_type == Run::RT_Iteration && !run.error_occurred) {
+                    times[run.benchmark_name()] = run.GetAdjustedCPUTime();
+                }
+            }
+        }
+
+        //returns the number of combinators slower than their lambdas by more than maxOverhead
+        std::size_t reportOverhead(double maxOverhead) const
+        {
+            const auto marker = "/combinator/"s;
+            auto failures = std::size_t{ 0 };
+            for (const auto& [name, time] : times) {
+                const auto pos = name.find(marker);
+                if (pos == std::string::npos) {
+                    continue;
+                }
+                auto lambdaName = name;
+                lambdaName.replace(pos, marker.size(), "/lambda/");
+                const auto lambda = times.find(lambdaName);
+                if (lambda != times.end() && time > lambda->second * (1.0 + maxOverhead)) {
+                    std::cerr << "overhead: " << name << " takes " << time / lambda->second
+                              << "x the time of its lambda\n";
+                    ++failures;
+                }
+            }
+            return failures;
+        }
+
+    private:
+        std::map<std::string, double> times;
+    };
+} //namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    auto maxOverhead = 0.05;
+    const auto flag = std::string_view{ "--max_overhead=" };
+    for (auto i = 1; i < argc; ++i) {
+        if (std::string_view{ argv[i] }.starts_with(flag)) {
+            maxOverhead = std::atof(argv[i] + flag.size());
+        }
+        else {
+            std::cerr << "unknown argument: " << argv[i] << '\n';
+            return 2;
+        }
+    }
+
+    registerNumeric<int>("int");
+    registerNumeric<double>("double");
+    registerStrings();
+    registerRecords();
+
+    auto reporter = OverheadReporter{};
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    return reporter.reportOverhead(maxOverhead) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+//Instantiates the coroutines of the generators and the sources, which must compile without warnings.
+//Built by CMake with -Wall -Wextra -Werror as part of the tests.
+
+#include "include/source.hpp"
+#include "include/generator.hpp"
+#include "include/pipeline.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace IDragnev::Functional
+{
+    std::size_t countLines(const std::string& path)
+    {
+        auto result = std::size_t{ 0 };
+        for (auto line : mmapSource(path, lines)) {
+            result += !line.empty();
+        }
+        return result;
+    }
+
+    int sum(const std::vector<int>& nums, std::pmr::memory_resource* resource)
+    {
+        return generate(nums, std::pmr::polymorphic_allocator<std::byte>{ resource }) | map(plus(1)) | fold(std::plus{}, 0);
+    }
+
+    std::size_t countBytes(int fd, std::pmr::memory_resource* resource)
+    {
+        auto result = std::size_t{ 0 };
+        for (auto chunk : chunkedReader(fd, 4096, std::pmr::polymorphic_allocator<std::byte>{ resource })) {
+            result += chunk.size();
+        }
+        return result;
+    }
+} //namespace IDragnev::Functional